@@ -0,0 +1,137 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ActorGrid.h"
+
+#include "Scriptable/Actor.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace GemRB {
+
+void ActorGrid::Resize(const Size& mapSize)
+{
+	gridSize.w = std::max(1, (mapSize.w + CELL_SIZE - 1) / CELL_SIZE);
+	gridSize.h = std::max(1, (mapSize.h + CELL_SIZE - 1) / CELL_SIZE);
+
+	std::vector<Actor*> actors;
+	for (const auto& cell : cells) {
+		for (const auto& entry : cell) {
+			actors.push_back(entry.actor);
+		}
+	}
+	cells.assign(gridSize.Area(), {});
+	for (Actor* actor : actors) {
+		Location& location = locations[actor];
+		location.cell = CellOf(actor->Pos);
+		cells[location.cell].push_back({ actor, location.order });
+	}
+}
+
+// actors off the map are kept at the edges
+int ActorGrid::CellOf(const Point& p) const
+{
+	int x = Clamp(p.x / CELL_SIZE, 0, gridSize.w - 1);
+	int y = Clamp(p.y / CELL_SIZE, 0, gridSize.h - 1);
+	return y * gridSize.w + x;
+}
+
+void ActorGrid::Unlink(int cell, const Actor* actor)
+{
+	auto& entries = cells[cell];
+	auto entry = std::find_if(entries.begin(), entries.end(), [actor](const Entry& e) {
+		return e.actor == actor;
+	});
+	if (entry != entries.end()) {
+		*entry = entries.back();
+		entries.pop_back();
+	}
+}
+
+void ActorGrid::Insert(Actor* actor)
+{
+	if (locations.find(actor) != locations.end()) return;
+
+	int cell = CellOf(actor->Pos);
+	locations[actor] = { cell, nextOrder };
+	cells[cell].push_back({ actor, nextOrder });
+	++nextOrder;
+	maxCircleSize = std::max(maxCircleSize, actor->circleSize);
+}
+
+void ActorGrid::Remove(const Actor* actor)
+{
+	auto location = locations.find(actor);
+	if (location == locations.end()) return;
+
+	Unlink(location->second.cell, actor);
+	locations.erase(location);
+}
+
+void ActorGrid::Update(const Actor* actor)
+{
+	auto location = locations.find(actor);
+	if (location == locations.end()) return;
+
+	maxCircleSize = std::max(maxCircleSize, actor->circleSize);
+	int cell = CellOf(actor->Pos);
+	if (cell == location->second.cell) return;
+
+	Unlink(location->second.cell, actor);
+	location->second.cell = cell;
+	cells[cell].push_back({ const_cast<Actor*>(actor), location->second.order });
+}
+
+std::vector<Actor*> ActorGrid::Query(const Point& p, unsigned int radius) const
+{
+	int reach = int(std::min<unsigned int>(radius, INT_MAX / 2));
+	return Query(Region(p.x - reach, p.y - reach, 2 * reach + 1, 2 * reach + 1));
+}
+
+std::vector<Actor*> ActorGrid::Query(const Region& rgn) const
+{
+	// the largest of Selectable::IsOver and the personal distance reach
+	int margin = std::max(16, (maxCircleSize - 1) * 16);
+	Point topLeft = rgn.origin - Point(margin, margin);
+	Point bottomRight = rgn.origin + Point(rgn.w + margin, rgn.h + margin);
+	int first = CellOf(topLeft);
+	int last = CellOf(bottomRight);
+
+	std::vector<Entry> found;
+	for (int y = first / gridSize.w; y <= last / gridSize.w; ++y) {
+		for (int x = first % gridSize.w; x <= last % gridSize.w; ++x) {
+			const auto& entries = cells[y * gridSize.w + x];
+			found.insert(found.end(), entries.begin(), entries.end());
+		}
+	}
+
+	std::sort(found.begin(), found.end(), [](const Entry& a, const Entry& b) {
+		return a.order < b.order;
+	});
+	std::vector<Actor*> actors;
+	actors.reserve(found.size());
+	for (const auto& entry : found) {
+		actors.push_back(entry.actor);
+	}
+	return actors;
+}
+
+}
@@ -0,0 +1,78 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef ACTORGRID_H
+#define ACTORGRID_H
+
+#include "Region.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+
+/**
+ * Uniform grid over the navmap, bucketing the actors of an area by position, so
+ * the proximity queries of Map only look at the actors nearby instead of all of them.
+ * Actors report their moves through Map::UpdateActorGrid (see Scriptable::SetPos).
+ */
+class ActorGrid {
+public:
+	static constexpr int CELL_SIZE = 128; // in navmap pixels
+
+	void Resize(const Size& mapSize);
+	void Insert(Actor* actor);
+	void Remove(const Actor* actor);
+	/** rebuckets the actor after a move or resize, if it's in the grid at all */
+	void Update(const Actor* actor);
+	bool Contains(const Actor* actor) const { return locations.find(actor) != locations.end(); }
+
+	/** the actors that could be within radius of p, counting their circle, in the order they were added */
+	std::vector<Actor*> Query(const Point& p, unsigned int radius) const;
+	/** the actors that could be inside rgn or with their circle over it, in the order they were added */
+	std::vector<Actor*> Query(const Region& rgn) const;
+
+private:
+	struct Entry {
+		Actor* actor;
+		uint64_t order;
+	};
+
+	struct Location {
+		int cell;
+		uint64_t order;
+	};
+
+	Size gridSize;
+	std::vector<std::vector<Entry>> cells;
+	std::unordered_map<const Actor*, Location> locations;
+	uint64_t nextOrder = 0;
+	int maxCircleSize = 0; // never shrinks, it's only for the query margin
+
+	int CellOf(const Point& p) const;
+	void Unlink(int cell, const Actor* actor);
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ActorStatIndex.h"
+
+#include "ie_stats.h"
+
+#include "Scriptable/Actor.h"
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+namespace GemRB {
+
+static constexpr std::array<unsigned int, 9> indexedStats = {
+	IE_EA, IE_GENERAL, IE_RACE, IE_SPECIFIC, IE_SEX, IE_ALIGNMENT, IE_SUBRACE, IE_FACTION, IE_TEAM
+};
+
+static int SlotOf(unsigned int stat)
+{
+	auto it = std::find(indexedStats.begin(), indexedStats.end(), stat);
+	if (it == indexedStats.end()) return -1;
+	return int(it - indexedStats.begin());
+}
+
+bool ActorStatIndex::IsIndexed(unsigned int stat)
+{
+	return SlotOf(stat) >= 0;
+}
+
+bool ActorStatIndex::AnyChanged(const ieDword* before, const ieDword* after)
+{
+	return std::any_of(indexedStats.begin(), indexedStats.end(), [before, after](unsigned int stat) {
+		return before[stat] != after[stat];
+	});
+}
+
+void ActorStatIndex::Build(const std::vector<Actor*>& actors)
+{
+	buckets.assign(indexedStats.size(), {});
+	std::unordered_map<ieDword, size_t> bucketOf;
+	for (size_t slot = 0; slot < indexedStats.size(); ++slot) {
+		auto& statBuckets = buckets[slot];
+		bucketOf.clear();
+		for (size_t i = 0; i < actors.size(); ++i) {
+			// skip any partial values of an effect refresh in progress, its end will invalidate us if needed
+			ieDword value = actors[i]->GetSafeStat(indexedStats[slot]);
+			auto known = bucketOf.find(value);
+			if (known == bucketOf.end()) {
+				known = bucketOf.emplace(value, statBuckets.size()).first;
+				statBuckets.push_back({ value, {} });
+			}
+			statBuckets[known->second].actors.push_back(int(i));
+		}
+	}
+	dirty = false;
+}
+
+const std::vector<ActorStatIndex::Bucket>& ActorStatIndex::GetBuckets(unsigned int stat) const
+{
+	static const std::vector<Bucket> none;
+	int slot = SlotOf(stat);
+	if (slot < 0 || dirty) return none;
+	return buckets[slot];
+}
+
+}
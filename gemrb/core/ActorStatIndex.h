@@ -0,0 +1,63 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef ACTORSTATINDEX_H
+#define ACTORSTATINDEX_H
+
+#include "ie_types.h"
+
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+
+/**
+ * Groups the actors of an area by the stats used in IDS object matching ([ENEMY.HUMANOID] etc.),
+ * so EvaluateObject only needs to look at the actors with fitting values instead of all of them.
+ * It's rebuilt lazily, after Map::ActorStatsChanged reports a change in any of the stats or the actor list.
+ */
+class ActorStatIndex {
+public:
+	struct Bucket {
+		ieDword value;
+		std::vector<int> actors; // indices into the actor list, ascending
+	};
+
+	/** the single-stat IDS checks can use the index, anything else (class) goes through all actors */
+	static bool IsIndexed(unsigned int stat);
+	/** whether any of the indexed stats differ between the two stat blocks */
+	static bool AnyChanged(const ieDword* before, const ieDword* after);
+
+	void Build(const std::vector<Actor*>& actors);
+	void Invalidate() { dirty = true; }
+	bool IsDirty() const { return dirty; }
+
+	/** all the distinct values of the stat on the area, with the actors having them */
+	const std::vector<Bucket>& GetBuckets(unsigned int stat) const;
+
+private:
+	std::vector<std::vector<Bucket>> buckets; // per indexed stat
+	bool dirty = true;
+};
+
+}
+
+#endif
@@ -22,6 +22,8 @@
 
 #include "Interface.h"
 
+#include <algorithm>
+
 namespace GemRB {
 
 AnimationFactory::AnimationFactory(const ResRef& resref,
@@ -85,4 +87,23 @@ AnimationFactory::index_t AnimationFactory::GetCycleSize(index_t idx) const
 	return cycles[idx].FramesCount;
 }
 
+size_t AnimationFactory::GetFootprint() const
+{
+	size_t size = sizeof(AnimationFactory);
+	size += cycles.size() * sizeof(CycleEntry) + FLTable.size() * sizeof(index_t);
+	for (const auto& frame : frames) {
+		if (!frame) continue;
+		size += sizeof(Sprite2D) + frame->Frame.w * frame->Frame.h * frame->Format().Bpp;
+	}
+	return size;
+}
+
+// animations only keep the frames they got from GetCycle, not us
+bool AnimationFactory::InUse() const
+{
+	return std::any_of(frames.begin(), frames.end(), [](const Holder<Sprite2D>& frame) {
+		return frame.use_count() > 1;
+	});
+}
+
 }
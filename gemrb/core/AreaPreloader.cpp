@@ -0,0 +1,328 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "AreaPreloader.h"
+
+#include "GameData.h"
+#include "ImageMgr.h"
+#include "PluginMgr.h"
+#include "ResourceDesc.h"
+
+#include "Logging/Logging.h"
+#include "Streams/MemoryStream.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+AreaPreloader::~AreaPreloader()
+{
+	Stop();
+}
+
+bool AreaPreloader::Open(const path_t&, std::string desc)
+{
+	description = std::move(desc);
+	return true;
+}
+
+bool AreaPreloader::HasResource(StringView resname, SClass_ID type)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto lookup = files.find(ResRef(resname));
+	if (lookup == files.end()) return false;
+
+	return std::any_of(lookup->second.begin(), lookup->second.end(), [type](const Preloaded& file) {
+		return file.type == type;
+	});
+}
+
+bool AreaPreloader::HasResource(StringView resname, const ResourceDesc& type)
+{
+	return type.GetKeyType() && HasResource(resname, type.GetKeyType());
+}
+
+DataStream* AreaPreloader::GetResource(StringView resname, SClass_ID type)
+{
+	return Take(resname, type);
+}
+
+DataStream* AreaPreloader::GetResource(StringView resname, const ResourceDesc& type)
+{
+	if (!type.GetKeyType()) return nullptr;
+	return Take(resname, type.GetKeyType());
+}
+
+DataStream* AreaPreloader::Take(StringView resname, SClass_ID type)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto lookup = files.find(ResRef(resname));
+	if (lookup == files.end()) return nullptr;
+
+	auto& preloaded = lookup->second;
+	auto file = std::find_if(preloaded.begin(), preloaded.end(), [type](const Preloaded& f) {
+		return f.type == type;
+	});
+	if (file == preloaded.end()) return nullptr;
+
+	// the stream takes over the data
+	path_t name = fmt::format("{}.{}", lookup->first, TypeExt(type));
+	DataStream* stream = new MemoryStream(name, file->data, file->size);
+	bytes -= file->size;
+	preloaded.erase(file);
+	if (preloaded.empty()) {
+		files.erase(lookup);
+	}
+	return stream;
+}
+
+void AreaPreloader::Preload(const ResRef& area, bool day)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (std::find(requested.begin(), requested.end(), area) != requested.end()) {
+		return;
+	}
+
+	MakeRoom();
+	requested.push_back(area);
+	queue.push_back({ area, day });
+	if (!worker.joinable()) {
+		worker = std::thread(&AreaPreloader::Work, this);
+	}
+	wakeup.notify_one();
+}
+
+void AreaPreloader::Discard(const ResRef& area)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Drop(area);
+}
+
+void AreaPreloader::DiscardAllBut(const ResRef& keep)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<ResRef> others;
+	for (const auto& area : requested) {
+		if (area != keep) others.push_back(area);
+	}
+	for (const auto& area : others) {
+		Drop(area);
+	}
+}
+
+// the oldest requests are the least likely destinations by now
+void AreaPreloader::MakeRoom()
+{
+	while (bytes >= MAX_BYTES && !requested.empty()) {
+		ResRef oldest = requested.front(); // Drop erases it
+		Drop(oldest);
+	}
+}
+
+// expects the mutex to be held
+void AreaPreloader::Drop(const ResRef& area)
+{
+	requested.erase(std::remove(requested.begin(), requested.end(), area), requested.end());
+	queue.erase(std::remove_if(queue.begin(), queue.end(), [&area](const Request& request) {
+		return request.area == area;
+	}), queue.end());
+
+	for (auto it = files.begin(); it != files.end();) {
+		auto& preloaded = it->second;
+		for (auto file = preloaded.begin(); file != preloaded.end();) {
+			if (file->area == area) {
+				bytes -= file->size;
+				free(file->data);
+				file = preloaded.erase(file);
+			} else {
+				++file;
+			}
+		}
+		it = preloaded.empty() ? files.erase(it) : std::next(it);
+	}
+}
+
+void AreaPreloader::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	wakeup.notify_one();
+	if (worker.joinable()) {
+		worker.join();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	stop = false;
+	queue.clear();
+	requested.clear();
+	for (auto& entry : files) {
+		for (const auto& file : entry.second) {
+			free(file.data);
+		}
+	}
+	files.clear();
+	bytes = 0;
+}
+
+bool AreaPreloader::Cancelled(const ResRef& area)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (stop || bytes >= MAX_BYTES) return true;
+	// discarded while we were working on it
+	return std::find(requested.begin(), requested.end(), area) == requested.end();
+}
+
+void AreaPreloader::Work()
+{
+	while (true) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeup.wait(lock, [this]() { return stop || !queue.empty(); });
+			if (stop) return;
+
+			request = queue.front();
+			queue.pop_front();
+		}
+
+		PreloadAreaFiles(request);
+	}
+}
+
+// the reads mirror what AREImporter and WEDImporter need first
+void AreaPreloader::PreloadAreaFiles(const Request& request)
+{
+	// the ARE itself may still get replaced by the saved game copy, so it's only peeked at
+	DataStream* are = gamedata->GetResourceStream(request.area, IE_ARE_CLASS_ID, true);
+	if (!are) return;
+
+	char signature[8];
+	are->Read(signature, 8);
+	int bigheader = strncmp(signature, "AREAV9.1", 8) == 0 ? 16 : 0;
+	ResRef wedRef;
+	are->ReadResRef(wedRef);
+
+	std::vector<ResRef> creatures;
+	ieDword actorOffset = 0;
+	ieWord actorCount = 0;
+	are->Seek(0x54 + bigheader, GEM_STREAM_START);
+	are->ReadDword(actorOffset);
+	are->ReadWord(actorCount);
+	for (ieWord i = 0; i < actorCount; i++) {
+		ResRef creRef;
+		if (are->Seek(actorOffset + i * 0x110 + 0x80, GEM_STREAM_START) != GEM_OK) break;
+		are->ReadResRef(creRef);
+		creatures.push_back(creRef);
+	}
+	delete are;
+
+	if (wedRef.IsEmpty()) return;
+
+	std::vector<ResRef> tilesets;
+	DataStream* wed = Fetch(request.area, wedRef, IE_WED_CLASS_ID);
+	if (wed) {
+		ieDword overlayCount = 0;
+		ieDword overlayOffset = 0;
+		wed->Seek(8, GEM_STREAM_START);
+		wed->ReadDword(overlayCount);
+		wed->Seek(4, GEM_CURRENT_POS);
+		wed->ReadDword(overlayOffset);
+		for (ieDword i = 0; i < overlayCount; i++) {
+			ResRef tisRef;
+			if (wed->Seek(overlayOffset + i * 0x18 + 4, GEM_STREAM_START) != GEM_OK) break;
+			wed->ReadResRef(tisRef);
+			if (!tisRef.IsEmpty()) tilesets.push_back(tisRef);
+		}
+		Keep(request.area, wedRef, IE_WED_CLASS_ID, wed);
+	}
+
+	for (const auto& tisRef : tilesets) {
+		PreloadFile(request.area, tisRef, IE_TIS_CLASS_ID);
+	}
+
+	ResRef mapRef;
+	mapRef.Format("{:.6}SR", wedRef);
+	PreloadImage(request.area, mapRef);
+	mapRef.Format("{:.6}HT", wedRef);
+	PreloadImage(request.area, mapRef);
+	if (request.day) {
+		mapRef.Format("{:.6}LM", wedRef);
+	} else {
+		mapRef.Format("{:.6}LN", wedRef);
+	}
+	PreloadImage(request.area, mapRef);
+	PreloadImage(request.area, wedRef); // minimap
+
+	for (const auto& creRef : creatures) {
+		PreloadFile(request.area, creRef, IE_CRE_CLASS_ID);
+	}
+}
+
+DataStream* AreaPreloader::Fetch(const ResRef& area, const ResRef& name, SClass_ID type)
+{
+	if (name.IsEmpty() || Cancelled(area) || HasResource(name, type)) return nullptr;
+
+	return gamedata->GetResourceStream(name, type, true);
+}
+
+void AreaPreloader::Keep(const ResRef& area, const ResRef& name, SClass_ID type, DataStream* stream)
+{
+	strpos_t size = stream->Size();
+	void* data = malloc(size);
+	stream->Seek(0, GEM_STREAM_START);
+	if (stream->Read(data, size) != static_cast<strret_t>(size)) {
+		Log(WARNING, "AreaPreloader", "Failed reading {}.{}", name, TypeExt(type));
+		free(data);
+		delete stream;
+		return;
+	}
+	delete stream;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (stop || std::find(requested.begin(), requested.end(), area) == requested.end()) {
+		free(data);
+		return;
+	}
+	files[name].push_back({ area, type, data, size });
+	bytes += size;
+}
+
+void AreaPreloader::PreloadFile(const ResRef& area, const ResRef& name, SClass_ID type)
+{
+	DataStream* stream = Fetch(area, name, type);
+	if (stream) {
+		Keep(area, name, type, stream);
+	}
+}
+
+void AreaPreloader::PreloadImage(const ResRef& area, const ResRef& name)
+{
+	// the first type found wins, like in ResourceManager::GetResource
+	for (const auto& desc : PluginMgr::Get()->GetResourceDesc(&ImageMgr::ID)) {
+		SClass_ID type = desc.GetKeyType();
+		if (!type) return;
+		if (gamedata->Exists(name, type, true)) {
+			PreloadFile(area, name, type);
+			return;
+		}
+	}
+}
+
+}
@@ -0,0 +1,108 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef AREA_PRELOADER_H
+#define AREA_PRELOADER_H
+
+#include "exports.h"
+
+#include "Resource.h"
+#include "ResourceSource.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GemRB {
+
+/**
+ * Reads the files of areas the party is likely to travel to next on a
+ * background thread: the WED, its tilesets, the search, height and light
+ * maps, the minimap and the creatures placed in the ARE.
+ *
+ * It sits right behind the cache in the search path, so when the area is
+ * actually loaded the importers get the data straight from memory, while
+ * anything newer in the cache still wins. Each file is handed out only once,
+ * anything unused is dropped with Discard or DiscardAllBut. When the budget
+ * runs out, the oldest requests are dropped to make room for new ones.
+ */
+class GEM_EXPORT AreaPreloader : public ResourceSource {
+private:
+	struct Preloaded {
+		ResRef area;
+		SClass_ID type;
+		void* data;
+		strpos_t size;
+	};
+
+	struct Request {
+		ResRef area;
+		bool day;
+	};
+
+	// how much unclaimed data we're willing to hold
+	static constexpr size_t MAX_BYTES = 64 * 1024 * 1024;
+
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::thread worker;
+	bool stop = false;
+
+	std::deque<Request> queue;
+	std::vector<ResRef> requested; // queued or done areas, oldest first
+	ResRefMap<std::vector<Preloaded>> files;
+	size_t bytes = 0;
+
+	void Work();
+	void PreloadAreaFiles(const Request& request);
+	DataStream* Fetch(const ResRef& area, const ResRef& name, SClass_ID type);
+	void Keep(const ResRef& area, const ResRef& name, SClass_ID type, DataStream* stream);
+	void PreloadFile(const ResRef& area, const ResRef& name, SClass_ID type);
+	void PreloadImage(const ResRef& area, const ResRef& name);
+	bool Cancelled(const ResRef& area);
+	void Drop(const ResRef& area);
+	void MakeRoom();
+	DataStream* Take(StringView resname, SClass_ID type);
+
+public:
+	AreaPreloader() noexcept = default;
+	AreaPreloader(const AreaPreloader&) = delete;
+	AreaPreloader& operator=(const AreaPreloader&) = delete;
+	~AreaPreloader() override;
+
+	bool Open(const path_t& filename, std::string description) override;
+	bool HasResource(StringView resname, SClass_ID type) override;
+	bool HasResource(StringView resname, const ResourceDesc& type) override;
+	DataStream* GetResource(StringView resname, SClass_ID type) override;
+	DataStream* GetResource(StringView resname, const ResourceDesc& type) override;
+
+	/** queues the area, unless it was already requested */
+	void Preload(const ResRef& area, bool day);
+	/** drops whatever was preloaded for the area, which can then be requested again */
+	void Discard(const ResRef& area);
+	/** drops all other areas, eg. once the destination is known */
+	void DiscardAllBut(const ResRef& keep);
+	/** cancels all pending work and drops everything */
+	void Stop();
+};
+
+}
+
+#endif
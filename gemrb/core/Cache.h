@@ -24,6 +24,9 @@
 #include "globals.h"
 #include "ie_types.h"
 
+#include <array>
+#include <list>
+#include <mutex>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -34,13 +37,30 @@ namespace GemRB {
 using ReleaseFun = void (*)(void*);
 #endif
 
-/* Reference counting cache, a layer between STL containers and existing interfaces. */
-template<typename K, typename V, typename H>
+/* Default memory footprint estimate of cached values. */
+template<typename V>
+struct SizeOf {
+	size_t operator()(const V&) const { return sizeof(V); }
+};
+
+/* Reference counting cache, a layer between STL containers and existing interfaces.
+ *
+ * Thread-safe: the entries are spread over independently locked shards.
+ * Unreferenced entries are kept for reuse, until their combined footprint (as
+ * estimated by SIZE) exceeds the budget. Then the least recently released ones
+ * are evicted. Referenced entries are never evicted and don't count against it.
+ */
+template<typename K, typename V, typename H, typename SIZE = SizeOf<V>>
 class RCCache {
 private:
+	static constexpr size_t SHARDS = 8;
+
 	struct Value {
 		V value;
 		int64_t refCount = 1;
+		size_t footprint = 0;
+		// position in the eviction queue, only valid while unreferenced
+		typename std::list<K>::iterator queuePos;
 
 		explicit Value(V&& value)
 			: value(std::move(value)) {}
@@ -51,14 +71,65 @@ private:
 		{}
 	};
 
-	std::unordered_map<K, Value, H> map;
+	struct Shard {
+		// recursive, since loading a resource may request others
+		std::recursive_mutex mutex;
+		std::unordered_map<K, Value, H> map;
+		// unreferenced entries, least recently released first
+		std::list<K> released;
+		size_t releasedSize = 0;
+	};
+
+	std::array<Shard, SHARDS> shards;
+	const size_t shardBudget;
+	H hasher;
+	SIZE sizer;
+
+	Shard& GetShard(const K& key)
+	{
+		return shards[hasher(key) % SHARDS];
+	}
+
+	const Shard& GetShard(const K& key) const
+	{
+		return shards[hasher(key) % SHARDS];
+	}
+
+	// must be called with the shard locked
+	static void Acquire(Shard& shard, Value& valueItem)
+	{
+		if (valueItem.refCount == 0) {
+			shard.released.erase(valueItem.queuePos);
+			shard.releasedSize -= valueItem.footprint;
+		}
+		valueItem.refCount++;
+	}
+
+	// must be called with the shard locked
+	void Evict(Shard& shard)
+	{
+		while (shard.releasedSize > shardBudget && !shard.released.empty()) {
+			auto lookup = shard.map.find(shard.released.front());
+			shard.releasedSize -= lookup->second.footprint;
+			shard.released.pop_front();
+			shard.map.erase(lookup);
+		}
+	}
 
 public:
+	/* budget: how many bytes of unreferenced entries to keep around */
+	explicit RCCache(size_t budget = 8 * 1024 * 1024)
+		: shardBudget(budget / SHARDS) {}
+	RCCache(const RCCache&) = delete;
+	RCCache& operator=(const RCCache&) = delete;
+
 	V* GetResource(const K& key)
 	{
-		auto lookup = map.find(key);
-		if (lookup != map.cend()) {
-			lookup->second.refCount++;
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+		auto lookup = shard.map.find(key);
+		if (lookup != shard.map.cend()) {
+			Acquire(shard, lookup->second);
 
 			return &lookup->second.value;
 		}
@@ -66,36 +137,78 @@ public:
 		return nullptr;
 	}
 
+	/* Adds a new referenced entry, or references the existing one */
 	template<typename... ARGS>
 	std::pair<V*, bool> SetAt(const K& key, ARGS&&... args)
 	{
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::recursive_mutex> lock(shard.mutex);
 		auto insertion =
-			map.emplace(
+			shard.map.emplace(
 				std::piecewise_construct,
 				std::forward_as_tuple(key),
 				std::forward_as_tuple(std::forward<ARGS>(args)...));
 
+		if (!insertion.second) {
+			Acquire(shard, insertion.first->second);
+		}
 		return { &insertion.first->second.value, insertion.second };
 	}
 
+	/* Like SetAt, but a new entry is filled in by init before anyone else can see it.
+	 * If init returns false, the entry is dropped again and nullptr returned. */
+	template<typename INIT>
+	V* Load(const K& key, INIT&& init)
+	{
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+		auto insertion =
+			shard.map.emplace(
+				std::piecewise_construct,
+				std::forward_as_tuple(key),
+				std::forward_as_tuple());
+
+		auto& valueItem = insertion.first->second;
+		if (!insertion.second) {
+			Acquire(shard, valueItem);
+		} else if (!init(valueItem.value)) {
+			shard.map.erase(insertion.first);
+			return nullptr;
+		}
+		return &valueItem.value;
+	}
+
 	int64_t DecRef(const K& key, bool remove)
 	{
-		auto lookup = map.find(key);
+		Shard& shard = GetShard(key);
+		std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+		auto lookup = shard.map.find(key);
 
-		if (lookup != map.end()) {
+		if (lookup != shard.map.end()) {
 			auto& valueItem = lookup->second;
 
 			if (valueItem.refCount > 0) {
 				valueItem.refCount--;
+				if (valueItem.refCount > 0) {
+					return valueItem.refCount;
+				}
+			} else {
+				// released earlier without removal, so it is queued
+				shard.released.erase(valueItem.queuePos);
+				shard.releasedSize -= valueItem.footprint;
 			}
 
-			if (remove && valueItem.refCount == 0) {
-				map.erase(lookup);
-
-				return 0;
+			if (remove) {
+				shard.map.erase(lookup);
 			} else {
-				return valueItem.refCount;
+				// measured only now, since the value may be filled in after SetAt
+				valueItem.footprint = sizer(valueItem.value);
+				valueItem.queuePos = shard.released.insert(shard.released.end(), key);
+				shard.releasedSize += valueItem.footprint;
+				Evict(shard);
 			}
+
+			return 0;
 		}
 
 		return -1;
@@ -103,18 +216,20 @@ public:
 
 	int64_t RefCount(const K& key) const
 	{
-		auto lookup = map.find(key);
+		const Shard& shard = GetShard(key);
+		std::lock_guard<std::recursive_mutex> lock(const_cast<Shard&>(shard).mutex);
+		auto lookup = shard.map.find(key);
 
-		if (lookup != map.cend()) {
-			return lookup->second.RefCount;
+		if (lookup != shard.map.cend()) {
+			return lookup->second.refCount;
 		}
 
 		return -1;
 	}
 };
 
-template<typename V>
-using ResRefRCCache = RCCache<ResRef, V, CstrHashCI>;
+template<typename V, typename SIZE = SizeOf<V>>
+using ResRefRCCache = RCCache<ResRef, V, CstrHashCI, SIZE>;
 
 }
 
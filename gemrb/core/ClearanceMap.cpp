@@ -0,0 +1,147 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ClearanceMap.h"
+
+#include "Geometry.h"
+#include "Map.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+namespace {
+
+struct Offset {
+	BasePoint offset;
+	uint8_t radius; // the smallest circle that covers it
+};
+
+// all the cells of the largest circle, sorted by the smallest circle they're part of
+// the circles are filled like in Map::GetBlockedInRadiusTile and each contains the smaller ones
+const std::vector<Offset>& CircleOffsets()
+{
+	static const std::vector<Offset> offsets = []() {
+		std::vector<Offset> list;
+		list.push_back({ BasePoint(), 0 });
+		for (uint16_t r = 1; r <= ClearanceMap::MAX_SIZE - 2; ++r) {
+			const auto points = PlotCircle(BasePoint(), r);
+			for (size_t i = 0; i < points.size(); i += 2) {
+				for (int x = points[i + 1].x; x <= points[i].x; ++x) {
+					BasePoint offset(x, points[i].y);
+					auto known = std::find_if(list.begin(), list.end(), [&offset](const Offset& o) {
+						return o.offset == offset;
+					});
+					if (known == list.end()) {
+						list.push_back({ offset, uint8_t(r) });
+					}
+				}
+			}
+		}
+		return list;
+	}();
+	return offsets;
+}
+
+// the terrain lets any actor walk here, no matter what
+bool IsOpen(PathMapFlags flags)
+{
+	flags &= PathMapFlags::NOTACTOR;
+	if (bool(flags & (PathMapFlags::DOOR | PathMapFlags::SIDEWALL))) return false;
+	return bool(flags & (PathMapFlags::PASSABLE | PathMapFlags::TRAVEL));
+}
+
+}
+
+void ClearanceMap::Build(const TileProps& props)
+{
+	mapSize = props.GetSize();
+	cells.assign(mapSize.Area(), Cell());
+	dirty.clear();
+
+	for (int y = 0; y < mapSize.h; ++y) {
+		for (int x = 0; x < mapSize.w; ++x) {
+			Measure(props, SearchmapPoint(x, y));
+		}
+	}
+}
+
+void ClearanceMap::Invalidate(const SearchmapPoint& p)
+{
+	if (!mapSize.PointInside(p)) return;
+
+	for (const auto& o : CircleOffsets()) {
+		SearchmapPoint cell(p.x - o.offset.x, p.y - o.offset.y);
+		if (mapSize.PointInside(cell)) {
+			cells[cell.y * mapSize.w + cell.x] = Cell();
+		}
+	}
+	dirty.push_back(p);
+}
+
+void ClearanceMap::Update(const TileProps& props)
+{
+	if (dirty.empty()) return;
+
+	// door changes come in big batches of neighbouring cells
+	std::vector<SearchmapPoint> affected;
+	for (const auto& p : dirty) {
+		for (const auto& o : CircleOffsets()) {
+			SearchmapPoint cell(p.x - o.offset.x, p.y - o.offset.y);
+			if (mapSize.PointInside(cell)) {
+				affected.push_back(cell);
+			}
+		}
+	}
+	dirty.clear();
+
+	auto byIndex = [](const SearchmapPoint& a, const SearchmapPoint& b) {
+		return a.y < b.y || (a.y == b.y && a.x < b.x);
+	};
+	std::sort(affected.begin(), affected.end(), byIndex);
+	affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+	for (const auto& cell : affected) {
+		Measure(props, cell);
+	}
+}
+
+void ClearanceMap::Measure(const TileProps& props, const SearchmapPoint& p)
+{
+	Cell& cell = cells[p.y * mapSize.w + p.x];
+	cell.open = MAX_SIZE;
+	cell.reach = MAX_SIZE;
+
+	bool openKnown = false;
+	for (const auto& o : CircleOffsets()) {
+		// size s checks the circle of radius s - 2
+		PathMapFlags flags = props.QuerySearchMap(SearchmapPoint(p.x + o.offset.x, p.y + o.offset.y));
+		if (!openKnown && !IsOpen(flags)) {
+			cell.open = o.radius + 1;
+			openKnown = true;
+		}
+		// actors are never marked on impassable cells, so this is final
+		if (flags == PathMapFlags::IMPASSABLE) {
+			cell.reach = o.radius + 1;
+			return;
+		}
+	}
+}
+
+}
@@ -0,0 +1,76 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef CLEARANCEMAP_H
+#define CLEARANCEMAP_H
+
+#include "PathFinder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace GemRB {
+
+class TileProps;
+
+/**
+ * Per searchmap cell, which creature sizes fit there as far as the terrain and doors are
+ * concerned, so Map::GetBlockedInRadiusTile can skip walking the circle in the common cases.
+ * Actors are ignored, since they move all the time. Changed cells are just forgotten and
+ * answered the slow way until the next Update.
+ */
+class ClearanceMap {
+public:
+	// the largest circle size the searchmap checks cover, see Map::GetBlockedInRadiusTile
+	static constexpr uint8_t MAX_SIZE = 8;
+
+	void Build(const TileProps& props);
+	/** forgets what we know about the cells whose circles cover p */
+	void Invalidate(const SearchmapPoint& p);
+	void Update(const TileProps& props);
+
+	/** the whole circle is walkable ground, so only actors could be in the way */
+	bool OnOpenGround(const SearchmapPoint& p, uint16_t size) const
+	{
+		return mapSize.PointInside(p) && std::max<uint16_t>(size, 2) <= cells[p.y * mapSize.w + p.x].open;
+	}
+	/** the circle reaches something impassable, regardless of doors and actors */
+	bool HitsImpassable(const SearchmapPoint& p, uint16_t size) const
+	{
+		return mapSize.PointInside(p) && size > cells[p.y * mapSize.w + p.x].reach;
+	}
+
+private:
+	struct Cell {
+		uint8_t open = 0; // the largest size only covering open ground, 0 if unknown
+		uint8_t reach = MAX_SIZE; // the largest size not covering any impassable cell
+	};
+
+	Size mapSize;
+	std::vector<Cell> cells;
+	std::vector<SearchmapPoint> dirty;
+
+	void Measure(const TileProps& props, const SearchmapPoint& p);
+};
+
+}
+
+#endif
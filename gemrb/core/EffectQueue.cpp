@@ -42,6 +42,8 @@
 #include "Logging/Logging.h"
 #include "Scriptable/Actor.h"
 
+#include <algorithm>
+
 namespace GemRB {
 
 static std::vector<EffectDesc> effectnames;
@@ -442,6 +444,58 @@ Effect* EffectQueue::CreateUnsummonEffect(const Effect* fx)
 	return newfx;
 }
 
+EffectQueue::EffectQueue(const EffectQueue& other)
+	: effects(other.effects), Owner(other.Owner)
+{
+}
+
+EffectQueue::EffectQueue(EffectQueue&& other) noexcept
+	: effects(std::move(other.effects)), Owner(other.Owner)
+{
+	other.opcodeIndexDirty = true;
+}
+
+EffectQueue& EffectQueue::operator=(const EffectQueue& other)
+{
+	if (this != &other) {
+		effects = other.effects;
+		Owner = other.Owner;
+		opcodeIndexDirty = true;
+	}
+	return *this;
+}
+
+EffectQueue& EffectQueue::operator=(EffectQueue&& other) noexcept
+{
+	if (this != &other) {
+		effects = std::move(other.effects);
+		Owner = other.Owner;
+		opcodeIndexDirty = true;
+		other.opcodeIndexDirty = true;
+	}
+	return *this;
+}
+
+// the index is sorted by opcode, but keeps the queue order within each opcode
+EffectQueue::OpcodeRange EffectQueue::OfOpcode(ieDword opcode) const
+{
+	if (opcodeIndexDirty) {
+		opcodeIndex.clear();
+		for (const auto& fx : effects) {
+			opcodeIndex.emplace_back(fx.Opcode, const_cast<Effect*>(&fx));
+		}
+		std::stable_sort(opcodeIndex.begin(), opcodeIndex.end(), [](const IndexEntry& a, const IndexEntry& b) {
+			return a.first < b.first;
+		});
+		opcodeIndexDirty = false;
+	}
+
+	auto range = std::equal_range(opcodeIndex.begin(), opcodeIndex.end(), IndexEntry(opcode, nullptr), [](const IndexEntry& a, const IndexEntry& b) {
+		return a.first < b.first;
+	});
+	return { range.first, range.second };
+}
+
 void EffectQueue::AddEffect(Effect* fx, bool insert)
 {
 	if (insert) {
@@ -449,6 +503,7 @@ void EffectQueue::AddEffect(Effect* fx, bool insert)
 	} else {
 		effects.push_back(std::move(*fx));
 	}
+	opcodeIndexDirty = true;
 	delete fx;
 }
 
@@ -459,6 +514,7 @@ bool EffectQueue::RemoveEffect(const Effect* fx)
 	for (auto f = effects.begin(); f != effects.end(); ++f) {
 		if (*fx == *f) {
 			effects.erase(f);
+			opcodeIndexDirty = true;
 			return true;
 		}
 	}
@@ -487,12 +543,54 @@ void EffectQueue::Cleanup()
 	for (auto f = effects.begin(); f != effects.end();) {
 		if (f->TimingMode == FX_DURATION_JUST_EXPIRED) {
 			f = effects.erase(f);
+			opcodeIndexDirty = true;
 		} else {
 			++f;
 		}
 	}
 }
 
+bool EffectQueue::GetStatInputs(std::vector<StatInput>& inputs, ieDword& validUntil) const
+{
+	const auto& Opcodes = Globals::Get().Opcodes;
+
+	inputs.clear();
+	for (const auto& fx : effects) {
+		if (fx.Opcode >= Globals::MAX_EFFECTS || fx.FirstApply) return false;
+		if (fx.TimingMode == FX_DURATION_JUST_EXPIRED) return false;
+		int flags = Opcodes[fx.Opcode].Flags;
+		if (!(flags & EFFECT_STAT_ONLY) || flags & EFFECT_REINIT_ON_LOAD) return false;
+		// eg. the arrow deflection AC bonus also depends on the equipment
+		if (fx.IsVariable) return false;
+
+		switch (DelayType(fx.TimingMode & 0xff)) {
+			case TimingType::Permanent:
+				break;
+			case TimingType::Delayed:
+			case TimingType::Duration:
+				validUntil = std::min(validUntil, fx.Duration);
+				break;
+			default:
+				return false;
+		}
+		inputs.push_back({ fx.Opcode, fx.Parameter1, fx.Parameter2, fx.Duration, fx.TimingMode });
+	}
+	return true;
+}
+
+bool EffectQueue::HasStatInputs(const std::vector<StatInput>& inputs) const
+{
+	if (inputs.size() != effects.size()) return false;
+
+	auto input = inputs.begin();
+	for (const auto& fx : effects) {
+		if (fx.FirstApply) return false;
+		if (!(*input == StatInput { fx.Opcode, fx.Parameter1, fx.Parameter2, fx.Duration, fx.TimingMode })) return false;
+		++input;
+	}
+	return true;
+}
+
 //Handle the target flag when the effect is applied first
 int EffectQueue::AddEffect(Effect* fx, Scriptable* self, Actor* pretarget, const Point& dest) const
 {
@@ -1302,8 +1400,14 @@ int EffectQueue::ApplyEffect(Actor* target, Effect* fx, ieDword first_apply, ieD
 		}
 	}
 
+	ieDword opcode = fx->Opcode;
 	res = ed(Owner, target, fx);
 	fx->FirstApply = 0;
+	// some effects turn into others, which has to be reflected in the opcode index of their queue
+	if (fx->Opcode != opcode) {
+		opcodeIndexDirty = true;
+		if (target) target->fxqueue.opcodeIndexDirty = true;
+	}
 
 	switch (res) {
 		case FX_APPLIED:
@@ -1376,7 +1480,7 @@ static inline bool IsLive(ieByte timingmode)
 //will be killed along with it
 void EffectQueue::RemoveAllEffects(ieDword opcode)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -1553,7 +1657,7 @@ void EffectQueue::RemoveAllEffects(EffectRef& effectReference)
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithResource(ieDword opcode, const ResRef& resource)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (fx.Resource != resource) {
@@ -1574,7 +1678,7 @@ void EffectQueue::RemoveAllEffectsWithResource(EffectRef& effectReference, const
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithSource(ieDword opcode, const ResRef& source, int mode)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		if (fx.SourceRef != source) continue;
 
@@ -1605,7 +1709,7 @@ void EffectQueue::RemoveAllEffectsWithSource(EffectRef& effectReference, const R
 //(works only if a higher stat means good for the target)
 void EffectQueue::RemoveAllDetrimentalEffects(ieDword opcode, ieDword current)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -1642,7 +1746,7 @@ void EffectQueue::RemoveAllDetrimentalEffects(EffectRef& effectReference, ieDwor
 //opcode need to be removed (see removal of portrait icon)
 void EffectQueue::RemoveAllEffectsWithParam(ieDword opcode, ieDword param, bool param1)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (param1) {
@@ -1671,7 +1775,7 @@ void EffectQueue::RemoveAllEffectsWithParam1(EffectRef& effectReference, ieDword
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithParamAndResource(ieDword opcode, ieDword param2, const ResRef& resource)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		MATCH_PARAM2()
@@ -1801,7 +1905,7 @@ bool EffectQueue::RollDispelChance(ieDword casterLevel, ieDword level)
 
 const Effect* EffectQueue::HasOpcode(ieDword opcode) const
 {
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -1821,7 +1925,7 @@ const Effect* EffectQueue::HasEffect(EffectRef& effectReference) const
 
 Effect* EffectQueue::HasOpcode(ieDword opcode)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -1841,7 +1945,7 @@ Effect* EffectQueue::HasEffect(EffectRef& effectReference)
 
 const Effect* EffectQueue::HasOpcodeWithParam(ieDword opcode, ieDword param2) const
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		MATCH_PARAM2()
@@ -1866,7 +1970,7 @@ const Effect* EffectQueue::HasEffectWithParam(EffectRef& effectReference, ieDwor
 
 const Effect* EffectQueue::HasOpcodeWithParamPair(ieDword opcode, ieDword param1, ieDword param2) const
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		MATCH_PARAM2()
@@ -1894,7 +1998,7 @@ const Effect* EffectQueue::HasEffectWithParamPair(EffectRef& effectReference, ie
 bool EffectQueue::DecreaseParam1OfEffect(ieDword opcode, ieDword amount)
 {
 	bool found = false;
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		ieDword& amount_left = fx.Parameter1;
@@ -1922,7 +2026,7 @@ bool EffectQueue::DecreaseParam1OfEffect(EffectRef& effectReference, ieDword amo
 //returns the damage amount NOT soaked
 int EffectQueue::DecreaseParam3OfEffect(ieDword opcode, ieDword amount, ieDword param2)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		MATCH_PARAM2()
@@ -1961,7 +2065,7 @@ static const int ids_stats[9] = { IE_FACTION, IE_TEAM, IE_EA, IE_GENERAL, IE_RAC
 int EffectQueue::BonusAgainstCreature(ieDword opcode, const Actor* actor) const
 {
 	ieDword sum = 0;
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (fx.Parameter1) {
@@ -2013,7 +2117,7 @@ int EffectQueue::BonusAgainstCreature(EffectRef& effectReference, const Actor* a
 int EffectQueue::BonusForParam2(ieDword opcode, ieDword param2) const
 {
 	int sum = 0;
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		MATCH_PARAM2()
@@ -2035,7 +2139,7 @@ int EffectQueue::MaxParam1(ieDword opcode, bool positive) const
 {
 	int max = 0;
 	ieDwordSigned param1 = 0;
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -2058,7 +2162,7 @@ int EffectQueue::MaxParam1(EffectRef& effectReference, bool positive) const
 
 bool EffectQueue::WeaponImmunity(ieDword opcode, int enchantment, ieDword weapontype) const
 {
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -2098,7 +2202,7 @@ void EffectQueue::AddWeaponEffects(EffectQueue* fxqueue, EffectRef& fx_ref, ieDw
 	ieDword opcode = fx_ref.opcode;
 	Point p(-1, -1);
 
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (!param2 && fx.Parameter2 != param2) continue;
@@ -2118,7 +2222,7 @@ int EffectQueue::SumDamageReduction(EffectRef& effectReference, ieDword weaponEn
 	int remaining = 0;
 	int count = 0;
 
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 
@@ -2139,7 +2243,7 @@ int EffectQueue::SumDamageReduction(EffectRef& effectReference, ieDword weaponEn
 //useful for immunity vs spell, can't use item, etc.
 const Effect* EffectQueue::HasOpcodeWithResource(ieDword opcode, const ResRef& resource) const
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (fx.Resource != resource) continue;
@@ -2164,7 +2268,7 @@ const Effect* EffectQueue::HasEffectWithPower(EffectRef& effectReference, ieDwor
 
 const Effect* EffectQueue::HasOpcodeWithPower(ieDword opcode, ieDword power) const
 {
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		// NOTE: matching greater or equals!
@@ -2192,7 +2296,7 @@ const Effect* EffectQueue::HasSource(const ResRef& removed) const
 //used in contingency/sequencer code (cannot have the same contingency twice)
 const Effect* EffectQueue::HasOpcodeWithSource(ieDword opcode, const ResRef& removed) const
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (removed != fx.SourceRef) {
@@ -2278,17 +2382,23 @@ Effect* EffectQueue::GetNextEffect(queue_t::iterator& f)
 ieDword EffectQueue::CountEffects(ieDword opcode, ieDword param1, ieDword param2, const ResRef& resource, const ResRef& source) const
 {
 	ieDword cnt = 0;
-
-	for (const auto& fx : effects) {
-		if (opcode != 0xffffffff)
-			MATCH_OPCODE()
-		if (param1 != 0xffffffff)
-			MATCH_PARAM1()
-		if (param2 != 0xffffffff)
-			MATCH_PARAM2()
-		if (!resource.IsEmpty() && fx.Resource != resource) continue;
-		if (!source.IsEmpty() && fx.SourceRef != source) continue;
+	auto count = [&](const Effect& fx) {
+		if (param1 != 0xffffffff && fx.Parameter1 != param1) return;
+		if (param2 != 0xffffffff && fx.Parameter2 != param2) return;
+		if (!resource.IsEmpty() && fx.Resource != resource) return;
+		if (!source.IsEmpty() && fx.SourceRef != source) return;
 		cnt++;
+	};
+
+	if (opcode == 0xffffffff) {
+		for (const auto& fx : effects) {
+			count(fx);
+		}
+		return cnt;
+	}
+	for (const auto& fx : OfOpcode(opcode)) {
+		MATCH_OPCODE()
+		count(fx);
 	}
 	return cnt;
 }
@@ -2298,7 +2408,7 @@ unsigned int EffectQueue::GetEffectOrder(EffectRef& effectReference, const Effec
 	ieDword cnt = 1;
 	ieDword opcode = ResolveEffect(effectReference);
 
-	for (const auto& fx : effects) {
+	for (const auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
 		if (&fx == fx2) break;
@@ -2309,7 +2419,7 @@ unsigned int EffectQueue::GetEffectOrder(EffectRef& effectReference, const Effec
 
 void EffectQueue::ModifyEffectPoint(ieDword opcode, ieDword x, ieDword y)
 {
-	for (auto& fx : effects) {
+	for (auto& fx : OfOpcode(opcode)) {
 		MATCH_OPCODE()
 		fx.Pos = Point(x, y);
 		fx.Parameter3 = 0;
@@ -34,6 +34,8 @@
 
 #include <cstdlib>
 #include <list>
+#include <utility>
+#include <vector>
 
 namespace GemRB {
 
@@ -165,6 +167,7 @@ enum EffectFlags {
 	EFFECT_PRESET_TARGET = 16,
 	EFFECT_SPECIAL_UNDO = 32,
 	EFFECT_TAMING = 64,
+	EFFECT_STAT_ONLY = 128, // just modifies stats, combat boni, portrait icons or spell states, so it can be cached
 };
 
 // unusual SpellProt types which need hacking (fake stats)
@@ -215,8 +218,41 @@ private:
 	/** Actor which is target of the Effects */
 	Scriptable* Owner = nullptr;
 
+	/** the effects sorted by opcode, so the opcode queries skip the rest; rebuilt when the queue changes */
+	using IndexEntry = std::pair<ieDword, Effect*>;
+	mutable std::vector<IndexEntry> opcodeIndex;
+	mutable bool opcodeIndexDirty = true;
+
+	class OpcodeRange {
+		using index_t = std::vector<IndexEntry>::const_iterator;
+		struct iterator {
+			index_t entry;
+			Effect& operator*() const { return *entry->second; }
+			iterator& operator++()
+			{
+				++entry;
+				return *this;
+			}
+			bool operator!=(const iterator& other) const { return entry != other.entry; }
+		};
+		index_t first;
+		index_t last;
+
+	public:
+		OpcodeRange(index_t first, index_t last)
+			: first(first), last(last) {}
+		iterator begin() const { return { first }; }
+		iterator end() const { return { last }; }
+	};
+	/** the effects with the opcode, in queue order */
+	OpcodeRange OfOpcode(ieDword opcode) const;
+
 public:
 	EffectQueue() noexcept {};
+	EffectQueue(const EffectQueue& other);
+	EffectQueue(EffectQueue&& other) noexcept;
+	EffectQueue& operator=(const EffectQueue& other);
+	EffectQueue& operator=(EffectQueue&& other) noexcept;
 
 	explicit operator bool() const
 	{
@@ -242,6 +278,26 @@ public:
 	/** remove effects marked for removal */
 	void Cleanup();
 
+	/** what reapplying an EFFECT_STAT_ONLY effect depends on */
+	struct StatInput {
+		ieDword opcode;
+		ieDword param1;
+		ieDword param2;
+		ieDword duration;
+		ieWord timingMode;
+
+		bool operator==(const StatInput& other) const
+		{
+			return opcode == other.opcode && param1 == other.param1 && param2 == other.param2 &&
+				duration == other.duration && timingMode == other.timingMode;
+		}
+	};
+	/** collects the inputs of all effects, false if any does more than modify stats;
+	 * validUntil is lowered to the game time when the first effect triggers or expires */
+	bool GetStatInputs(std::vector<StatInput>& inputs, ieDword& validUntil) const;
+	/** true if the effects are still exactly the ones GetStatInputs described */
+	bool HasStatInputs(const std::vector<StatInput>& inputs) const;
+
 	/* directly removes effects with specified opcode, use effectReference when you can */
 	void RemoveAllEffects(ieDword opcode);
 
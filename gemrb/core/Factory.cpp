@@ -20,32 +20,79 @@
 
 #include "Factory.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace GemRB {
 
-void Factory::AddFactoryObject(object_t fobject)
+void Factory::AddFactoryObject(object_t fobject, bool permanent)
 {
-	fobjects.push_back(std::move(fobject));
+	Entry& entry = fobjects[Key { fobject->resRef, fobject->SuperClassID }];
+	if (entry.object && !entry.permanent) {
+		cachedSize -= entry.footprint;
+	}
+
+	entry.footprint = fobject->GetFootprint();
+	entry.permanent = permanent;
+	entry.lastUse = ++useCounter;
+	entry.object = std::move(fobject);
+	if (permanent) return;
+
+	cachedSize += entry.footprint;
+	if (cachedSize > evictAt) {
+		Evict();
+	}
 }
 
-int Factory::IsLoaded(const ResRef& resref, SClass_ID type) const
+Factory::object_t Factory::GetFactoryObject(const ResRef& resref, SClass_ID type)
 {
 	if (resref.IsEmpty()) {
-		return -1;
+		return nullptr;
 	}
 
-	for (unsigned int i = 0; i < fobjects.size(); i++) {
-		if (fobjects[i]->SuperClassID == type) {
-			if (fobjects[i]->resRef == resref) {
-				return i;
-			}
-		}
+	auto lookup = fobjects.find(Key { resref, type });
+	if (lookup == fobjects.end()) {
+		return nullptr;
 	}
-	return -1;
+	lookup->second.lastUse = ++useCounter;
+	return lookup->second.object;
 }
 
-Factory::object_t Factory::GetFactoryObject(int pos) const
+void Factory::SetBudget(size_t newBudget)
 {
-	return fobjects[pos];
+	budget = newBudget;
+	evictAt = budget;
+	if (cachedSize > evictAt) {
+		Evict();
+	}
+}
+
+// drops the least recently used objects nobody else holds, until we're
+// a good bit below the budget, so we don't end up here on every load
+void Factory::Evict()
+{
+	std::vector<std::pair<unsigned long, Key>> unused;
+	for (const auto& fobject : fobjects) {
+		const Entry& entry = fobject.second;
+		if (!entry.permanent && entry.object.use_count() == 1 && !entry.object->InUse()) {
+			unused.emplace_back(entry.lastUse, fobject.first);
+		}
+	}
+	std::sort(unused.begin(), unused.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	size_t target = budget / 4 * 3;
+	for (const auto& candidate : unused) {
+		if (cachedSize <= target) break;
+		auto lookup = fobjects.find(candidate.second);
+		cachedSize -= lookup->second.footprint;
+		fobjects.erase(lookup);
+	}
+
+	// if what's in use alone is over the budget, wait for a good chunk of new
+	// loads before scanning again, instead of doing it on every single one
+	evictAt = std::max(budget, cachedSize + budget / 4);
 }
 
 }
@@ -26,23 +26,57 @@
 #include "FactoryObject.h"
 
 #include <memory>
+#include <unordered_map>
 
 namespace GemRB {
 
+/* Cache of the loaded factory objects, indexed by resref and type.
+ *
+ * Once the footprint of everything cached exceeds the budget, the least recently
+ * used objects are dropped, unless they or their frames are still held elsewhere.
+ * They get loaded again when needed. Permanent objects are never dropped.
+ */
 class GEM_EXPORT Factory {
 public:
 	using object_t = std::shared_ptr<FactoryObject>;
 
-	Factory() noexcept = default;
+	explicit Factory(size_t budget = 32 * 1024 * 1024) noexcept
+		: budget(budget), evictAt(budget) {};
 	Factory(const Factory&) = delete;
 	Factory& operator=(const Factory&) = delete;
 
-	void AddFactoryObject(object_t fobject);
-	int IsLoaded(const ResRef& resRef, SClass_ID type) const;
-	object_t GetFactoryObject(int pos) const;
+	/* permanent is for objects that were built in code and can't be reloaded */
+	void AddFactoryObject(object_t fobject, bool permanent = false);
+	/* returns nullptr if the object isn't cached */
+	object_t GetFactoryObject(const ResRef& resRef, SClass_ID type);
+	void SetBudget(size_t newBudget);
 
 private:
-	std::vector<object_t> fobjects;
+	struct Key {
+		ResRef resRef;
+		SClass_ID type;
+
+		bool operator==(const Key& other) const { return type == other.type && resRef == other.resRef; }
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const { return CstrHashCI()(key.resRef) ^ key.type; }
+	};
+
+	struct Entry {
+		object_t object;
+		size_t footprint = 0;
+		bool permanent = false;
+		unsigned long lastUse = 0;
+	};
+
+	std::unordered_map<Key, Entry, KeyHash> fobjects;
+	size_t budget;
+	size_t cachedSize = 0; // of the evictable objects
+	size_t evictAt; // raised when too much is in use to get below the budget
+	unsigned long useCounter = 0;
+
+	void Evict();
 };
 
 }
@@ -36,6 +36,11 @@ public:
 	FactoryObject(const ResRef& name, SClass_ID superClassID)
 		: SuperClassID(superClassID), resRef(name) {};
 	virtual ~FactoryObject() noexcept = default;
+
+	/* estimated memory use, for the cache budget */
+	virtual size_t GetFootprint() const { return sizeof(FactoryObject); }
+	/* whether anything still uses the data, even after dropping the factory itself */
+	virtual bool InUse() const { return false; }
 };
 
 }
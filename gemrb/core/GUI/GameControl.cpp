@@ -1488,6 +1488,9 @@ void GameControl::DebugPaint(const Point& p, bool sample) const noexcept
 			DebugPropVal = map->tileProps.QueryTileProp(tile, prop);
 		} else {
 			map->tileProps.SetTileProp(tile, prop, DebugPropVal);
+			if (prop == TileProps::Property::SEARCH_MAP) {
+				map->InvalidatePathfinderData(tile);
+			}
 		}
 	}
 }
@@ -2383,6 +2386,11 @@ void GameControl::CommandSelectedMovement(const Point& p, bool formation, bool a
 	bool doWorldMap = ShouldTriggerWorldMap(party[0]);
 
 	std::vector<Point> formationPoints = GetFormationPoints(p, party, angle);
+	// they all head the same way, so search just once for everyone
+	if (!append && party.size() > 1) {
+		std::vector<Point> destinations = formation ? formationPoints : std::vector<Point>(party.size(), p);
+		party[0]->GetCurrentArea()->PlanGroupMovement(party, destinations);
+	}
 	for (size_t i = 0; i < party.size(); i++) {
 		Actor* actor = party[i];
 		// don't stop the party if we're just trying to add a waypoint
@@ -24,6 +24,7 @@
 
 #include "DisplayMessage.h"
 #include "Game.h"
+#include "GameData.h"
 #include "Interface.h"
 #include "WorldMap.h"
 
@@ -72,6 +73,12 @@ WorldMapControl::WorldMapControl(const Region& frame, Holder<Font> font)
 			  Color(0x80, 0x80, 0xf0, 0xff))
 {}
 
+WorldMapControl::~WorldMapControl()
+{
+	// drop the hovered areas, but keep the one we're travelling to
+	gamedata->DiscardPreloadedAreas(destination);
+}
+
 void WorldMapControl::WillDraw(const Region& /*drawFrame*/, const Region& /*clip*/)
 {
 	if (hoverAnim) {
@@ -239,6 +246,8 @@ bool WorldMapControl::OnMouseOver(const MouseEvent& me)
 		SetCursor(core->Cursors[IE_CURSOR_NORMAL]);
 		Area = ae;
 		if (oldArea != ae) {
+			// a likely destination, so start reading it already
+			gamedata->PreloadArea(Area->AreaResRef);
 			const String str = core->GetString(HCStrings::TravelTime);
 			int hours = worldmap->GetDistance(Area->AreaName);
 			if (!str.empty() && hours >= 0) {
@@ -283,6 +292,11 @@ bool WorldMapControl::OnMouseUp(const MouseEvent& me, unsigned short Mod)
 {
 	if (me.button == GEM_MB_ACTION) {
 		SetCursor(core->Cursors[IE_CURSOR_GRAB]);
+		if (Area) {
+			// the other hovered areas won't be needed anymore
+			destination = Area->AreaResRef;
+			gamedata->DiscardPreloadedAreas(destination);
+		}
 		Control::OnMouseUp(me, Mod);
 	}
 	return true;
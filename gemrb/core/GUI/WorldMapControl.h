@@ -53,6 +53,7 @@ private:
 public:
 	WorldMapControl(const Region& frame, Holder<Font> font);
 	WorldMapControl(const Region& frame, Holder<Font> font, const Color& normal, const Color& selected, const Color& notvisited);
+	~WorldMapControl() override;
 
 	/** Allows modification of the scrolling factor from outside */
 	void ScrollDelta(const Point& delta) override;
@@ -84,6 +85,8 @@ private:
 	Holder<Font> ftext;
 	//current area
 	ResRef currentArea;
+	//chosen destination, if any
+	ResRef destination;
 
 	/** Label color of a visited area */
 
@@ -139,6 +139,7 @@ Game::Game(void)
 
 Game::~Game(void)
 {
+	gamedata->StopAreaPreloading();
 	delete weather;
 	for (auto map : Maps) {
 		delete map;
@@ -880,6 +881,8 @@ int Game::LoadMap(const ResRef& resRef, bool loadscreen)
 	}
 
 	Map* newMap = mM->GetMap(resRef, IsDay());
+	// whatever wasn't picked up is useless now
+	gamedata->DiscardPreloadedArea(resRef);
 	if (!newMap) {
 		core->LoadProgress(100);
 		return GEM_ERROR;
@@ -2398,9 +2401,11 @@ std::string Game::dump() const
 
 Actor* Game::GetActorByGlobalID(ieDword globalID) const
 {
+	Actor* actor = Scriptable::As<Actor>(Scriptable::FindByGlobalID(globalID));
+	if (!actor) return nullptr;
+
 	for (const auto& map : Maps) {
-		Actor* actor = map->GetActorByGlobalID(globalID);
-		if (actor) return actor;
+		if (map->HasActor(actor)) return actor;
 	}
 	return GetGlobalActorByGlobalID(globalID);
 }
@@ -51,8 +51,32 @@ namespace GemRB {
 
 GEM_EXPORT GameData* gamedata;
 
+size_t ItemFootprint::operator()(const Item& item) const
+{
+	size_t size = sizeof(Item);
+	size += item.equipping_features.size() * (sizeof(Effect*) + sizeof(Effect));
+	size += item.ext_headers.size() * sizeof(ITMExtHeader);
+	for (const auto& header : item.ext_headers) {
+		size += header.features.size() * (sizeof(Effect*) + sizeof(Effect));
+	}
+	return size;
+}
+
+size_t SpellFootprint::operator()(const Spell& spell) const
+{
+	size_t size = sizeof(Spell);
+	size += spell.casting_features.size() * sizeof(Effect);
+	size += spell.ext_headers.size() * sizeof(SPLExtHeader);
+	for (const auto& header : spell.ext_headers) {
+		size += header.features.size() * sizeof(Effect);
+	}
+	return size;
+}
+
 GameData::~GameData()
 {
+	// the worker uses us, so it has to finish first
+	StopAreaPreloading();
 	PaletteCache.clear();
 
 	while (!stores.empty()) {
@@ -173,11 +197,12 @@ Item* GameData::GetItem(const ResRef& resname, bool silent)
 		return nullptr;
 	}
 
-	auto newItem = ItemCache.SetAt(resname).first;
-	newItem->Name = resname;
-	sm->GetItem(newItem);
-
-	return newItem;
+	// another thread may have loaded it meanwhile, then ours is just dropped
+	return ItemCache.Load(resname, [&](Item& newItem) {
+		newItem.Name = resname;
+		sm->GetItem(&newItem);
+		return true;
+	});
 }
 
 //you can supply name for faster access
@@ -206,11 +231,11 @@ Spell* GameData::GetSpell(const ResRef& resname, bool silent)
 		return nullptr;
 	}
 
-	auto newSpell = SpellCache.SetAt(resname).first;
-	newSpell->Name = resname;
-	sm->GetSpell(newSpell, silent);
-
-	return newSpell;
+	return SpellCache.Load(resname, [&](Spell& newSpell) {
+		newSpell.Name = resname;
+		sm->GetSpell(&newSpell, silent);
+		return true;
+	});
 }
 
 void GameData::FreeSpell(const Spell* /*spl*/, const ResRef& name, bool free)
@@ -220,9 +245,12 @@ void GameData::FreeSpell(const Spell* /*spl*/, const ResRef& name, bool free)
 
 Effect* GameData::GetEffect(const ResRef& resname)
 {
+	// callers get a copy, so the cached entry is released right away
 	const Effect* effect = EffectCache.GetResource(resname);
 	if (effect) {
-		return new Effect(*effect);
+		Effect* effectCopy = new Effect(*effect);
+		EffectCache.DecRef(resname, false);
+		return effectCopy;
 	}
 	DataStream* str = GetResourceStream(resname, IE_EFF_CLASS_ID);
 	PluginHolder<EffectMgr> em = MakePluginHolder<EffectMgr>(IE_EFF_CLASS_ID);
@@ -240,6 +268,7 @@ Effect* GameData::GetEffect(const ResRef& resname)
 	}
 
 	EffectCache.SetAt(resname, *newEffect);
+	EffectCache.DecRef(resname, false);
 
 	auto effectCopy = new Effect(std::move(*newEffect));
 	delete newEffect;
@@ -252,6 +281,45 @@ void GameData::FreeEffect(const Effect* /*eff*/, const ResRef& name, bool free)
 	EffectCache.DecRef(name, free);
 }
 
+void GameData::EnableAreaPreloading()
+{
+	areaPreloader = std::make_shared<AreaPreloader>();
+	areaPreloader->Open("", "Preloaded areas");
+	// files are handed out only once, so it can never be memoized
+	// NOTE: add it after the cache, so newer copies there aren't shadowed
+	AddSource(areaPreloader, RM_VOLATILE_SOURCE);
+}
+
+void GameData::PreloadArea(const ResRef& area)
+{
+	const Game* game = core->GetGame();
+	if (!areaPreloader || !game || area.IsEmpty() || game->FindMap(area) >= 0) {
+		return;
+	}
+	areaPreloader->Preload(area, game->IsDay());
+}
+
+void GameData::DiscardPreloadedArea(const ResRef& area)
+{
+	if (areaPreloader) {
+		areaPreloader->Discard(area);
+	}
+}
+
+void GameData::DiscardPreloadedAreas(const ResRef& keep)
+{
+	if (areaPreloader) {
+		areaPreloader->DiscardAllBut(keep);
+	}
+}
+
+void GameData::StopAreaPreloading()
+{
+	if (areaPreloader) {
+		areaPreloader->Stop();
+	}
+}
+
 //if the default setup doesn't fit for an animation
 //create a vvc for it!
 ScriptedAnimation* GameData::GetScriptedAnimation(const ResRef& effect, bool doublehint)
@@ -330,8 +398,8 @@ Factory::object_t GameData::GetFactoryResource(const ResRef& resName, SClass_ID
 	if (resName.IsEmpty()) return nullptr;
 
 	// already cached?
-	int objectIndex = factory.IsLoaded(resName, type);
-	if (objectIndex != -1) return factory.GetFactoryObject(objectIndex);
+	auto cached = factory.GetFactoryObject(resName, type);
+	if (cached) return cached;
 
 	switch (type) {
 		case IE_BAM_CLASS_ID:
@@ -25,6 +25,7 @@
 #include "exports.h"
 #include "ie_types.h"
 
+#include "AreaPreloader.h"
 #include "Cache.h"
 #include "CharAnimations.h"
 #include "DisplayMessage.h"
@@ -53,6 +54,15 @@ class Store;
 class VEFObject;
 enum class Difficulty;
 
+// memory footprint estimates for the resource caches
+struct ItemFootprint {
+	size_t operator()(const Item& item) const;
+};
+
+struct SpellFootprint {
+	size_t operator()(const Spell& spell) const;
+};
+
 struct IWDIDSEntry {
 	ieDword value;
 	ieWord stat = USHRT_MAX;
@@ -117,6 +127,20 @@ public:
 	Effect* GetEffect(const ResRef& resname);
 	void FreeEffect(const Effect* eff, const ResRef& name, bool free = false);
 
+	/** how many bytes of loaded animations and images may be cached */
+	void SetFactoryBudget(size_t budget) { factory.SetBudget(budget); }
+
+	/** puts the area preloader in the search path, right behind the cache */
+	void EnableAreaPreloading();
+	/** starts reading the area files in the background, if it's not loaded already */
+	void PreloadArea(const ResRef& area);
+	/** drops the unused preloaded files of an area */
+	void DiscardPreloadedArea(const ResRef& area);
+	/** drops the unused preloaded files of all areas but keep (if any) */
+	void DiscardPreloadedAreas(const ResRef& keep = ResRef());
+	/** cancels all preloading, eg. when the game is unloaded */
+	void StopAreaPreloading();
+
 	/** creates a vvc/bam animation object at point */
 	ScriptedAnimation* GetScriptedAnimation(const ResRef& resRef, bool doublehint);
 
@@ -144,7 +168,7 @@ public:
 	{
 		static_assert(std::is_base_of<FactoryObject, T>::value, "T must be a FactoryObject.");
 		auto obj = std::make_shared<T>(std::forward<ARGS>(args)...);
-		factory.AddFactoryObject(obj);
+		factory.AddFactoryObject(obj, true);
 		return obj;
 	}
 
@@ -199,10 +223,12 @@ private:
 	void ReadSpellProtTable();
 
 private:
-	ResRefRCCache<Item> ItemCache;
-	ResRefRCCache<Spell> SpellCache;
-	ResRefRCCache<Effect> EffectCache;
+	// unreferenced entries are kept around until their budget is exceeded
+	ResRefRCCache<Item, ItemFootprint> ItemCache { 4 * 1024 * 1024 };
+	ResRefRCCache<Spell, SpellFootprint> SpellCache { 4 * 1024 * 1024 };
+	ResRefRCCache<Effect> EffectCache { 1024 * 1024 };
 	ResRefMap<Holder<Palette>> PaletteCache;
+	std::shared_ptr<AreaPreloader> areaPreloader;
 	Factory factory;
 	ResRefMap<AutoTable> tables;
 	using StoreMap = ResRefMap<Store*>;
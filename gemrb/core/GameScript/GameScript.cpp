@@ -54,6 +54,9 @@
 #include "GameScript/GSUtils.h"
 #include "GameScript/Matching.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace GemRB {
 
 //debug flags
@@ -73,12 +76,12 @@ static const TriggerLink triggernames[] = {
 	{ "actionlistempty", GameScript::ActionListEmpty, 0 },
 	{ "actuallyincombat", GameScript::ActuallyInCombat, 0 },
 	{ "acquired", GameScript::Acquired, 0 },
-	{ "alignment", GameScript::Alignment, 0 },
-	{ "allegiance", GameScript::Allegiance, 0 },
+	{ "alignment", GameScript::Alignment, TF_PURE },
+	{ "allegiance", GameScript::Allegiance, TF_PURE },
 	{ "animstate", GameScript::AnimState, 0 },
 	{ "anypconmap", GameScript::AnyPCOnMap, 0 },
 	{ "anypcseesenemy", GameScript::AnyPCSeesEnemy, 0 },
-	{ "areacheck", GameScript::AreaCheck, 0 },
+	{ "areacheck", GameScript::AreaCheck, TF_PURE },
 	{ "areacheckobject", GameScript::AreaCheckObject, 0 },
 	{ "areacheckallegiance", GameScript::AreaCheckAllegiance, 0 },
 	{ "areaflag", GameScript::AreaFlag, 0 },
@@ -116,10 +119,10 @@ static const TriggerLink triggernames[] = {
 	{ "checkskillgt", GameScript::CheckSkillGT, 0 },
 	{ "checkskilllt", GameScript::CheckSkillLT, 0 },
 	{ "checkspellstate", GameScript::CheckSpellState, 0 },
-	{ "checkstat", GameScript::CheckStat, 0 },
-	{ "checkstatgt", GameScript::CheckStatGT, 0 },
-	{ "checkstatlt", GameScript::CheckStatLT, 0 },
-	{ "class", GameScript::Class, 0 },
+	{ "checkstat", GameScript::CheckStat, TF_PURE },
+	{ "checkstatgt", GameScript::CheckStatGT, TF_PURE },
+	{ "checkstatlt", GameScript::CheckStatLT, TF_PURE },
+	{ "class", GameScript::Class, TF_PURE },
 	{ "classex", GameScript::ClassEx, 0 }, //will return true for multis
 	{ "classlevel", GameScript::ClassLevel, 0 }, //pst
 	{ "classlevelgt", GameScript::ClassLevelGT, 0 },
@@ -138,7 +141,7 @@ static const TriggerLink triggernames[] = {
 	{ "damagetaken", GameScript::DamageTaken, 0 },
 	{ "damagetakengt", GameScript::DamageTakenGT, 0 },
 	{ "damagetakenlt", GameScript::DamageTakenLT, 0 },
-	{ "dead", GameScript::Dead, 0 },
+	{ "dead", GameScript::Dead, TF_PURE },
 	{ "delay", GameScript::Delay, 0 },
 	{ "detect", GameScript::Detect, 0 }, //so far i see no difference
 	{ "detected", GameScript::Detected, 0 }, //trap or secret door detected
@@ -166,20 +169,20 @@ static const TriggerLink triggernames[] = {
 	{ "forcemarkedspell", GameScript::ForceMarkedSpell_Trigger, 0 },
 	{ "frame", GameScript::Frame, 0 },
 	{ "g", GameScript::G_Trigger, 0 },
-	{ "gender", GameScript::Gender, 0 },
-	{ "general", GameScript::General, 0 },
+	{ "gender", GameScript::Gender, TF_PURE },
+	{ "general", GameScript::General, TF_PURE },
 	{ "ggt", GameScript::GGT_Trigger, 0 },
 	{ "glt", GameScript::GLT_Trigger, 0 },
-	{ "global", GameScript::Global, TF_MERGESTRINGS },
+	{ "global", GameScript::Global, TF_MERGESTRINGS | TF_PURE },
 	{ "globalandglobal", GameScript::GlobalAndGlobal_Trigger, TF_MERGESTRINGS },
 	{ "globalband", GameScript::BitCheck, TF_MERGESTRINGS },
 	{ "globalbandglobal", GameScript::GlobalBAndGlobal_Trigger, TF_MERGESTRINGS },
 	{ "globalbandglobalexact", GameScript::GlobalBAndGlobalExact, TF_MERGESTRINGS },
 	{ "globalbitglobal", GameScript::GlobalBitGlobal_Trigger, TF_MERGESTRINGS },
 	{ "globalequalsglobal", GameScript::GlobalsEqual, TF_MERGESTRINGS }, //this is the same
-	{ "globalgt", GameScript::GlobalGT, TF_MERGESTRINGS },
+	{ "globalgt", GameScript::GlobalGT, TF_MERGESTRINGS | TF_PURE },
 	{ "globalgtglobal", GameScript::GlobalGTGlobal, TF_MERGESTRINGS },
-	{ "globallt", GameScript::GlobalLT, TF_MERGESTRINGS },
+	{ "globallt", GameScript::GlobalLT, TF_MERGESTRINGS | TF_PURE },
 	{ "globalltglobal", GameScript::GlobalLTGlobal, TF_MERGESTRINGS },
 	{ "globalorglobal", GameScript::GlobalOrGlobal_Trigger, TF_MERGESTRINGS },
 	{ "globalsequal", GameScript::GlobalsEqual, 0 },
@@ -223,15 +226,15 @@ static const TriggerLink triggernames[] = {
 	{ "helpex", GameScript::HelpEX, 0 },
 	{ "hitby", GameScript::HitBy, 0 },
 	{ "hotkey", GameScript::HotKey, 0 },
-	{ "hp", GameScript::HP, 0 },
-	{ "hpgt", GameScript::HPGT, 0 },
+	{ "hp", GameScript::HP, TF_PURE },
+	{ "hpgt", GameScript::HPGT, TF_PURE },
 	{ "hplost", GameScript::HPLost, 0 },
 	{ "hplostgt", GameScript::HPLostGT, 0 },
 	{ "hplostlt", GameScript::HPLostLT, 0 },
-	{ "hplt", GameScript::HPLT, 0 },
-	{ "hppercent", GameScript::HPPercent, 0 },
-	{ "hppercentgt", GameScript::HPPercentGT, 0 },
-	{ "hppercentlt", GameScript::HPPercentLT, 0 },
+	{ "hplt", GameScript::HPLT, TF_PURE },
+	{ "hppercent", GameScript::HPPercent, TF_PURE },
+	{ "hppercentgt", GameScript::HPPercentGT, TF_PURE },
+	{ "hppercentlt", GameScript::HPPercentLT, TF_PURE },
 	{ "ifvalidforpartydialog", GameScript::IsValidForPartyDialog, 0 },
 	{ "ifvalidforpartydialogue", GameScript::IsValidForPartyDialog, 0 },
 	{ "immunetospelllevel", GameScript::ImmuneToSpellLevel, 0 },
@@ -241,7 +244,7 @@ static const TriggerLink triggernames[] = {
 	{ "inline", GameScript::InLine, 0 },
 	{ "inmyarea", GameScript::InMyArea, 0 },
 	{ "inmygroup", GameScript::InMyGroup, 0 },
-	{ "inparty", GameScript::InParty, 0 },
+	{ "inparty", GameScript::InParty, TF_PURE },
 	{ "inpartyallowdead", GameScript::InPartyAllowDead, 0 },
 	{ "inpartyslot", GameScript::InPartySlot, 0 },
 	{ "internal", GameScript::Internal, 0 },
@@ -287,12 +290,12 @@ static const TriggerLink triggernames[] = {
 	{ "lastmarkedobject", GameScript::LastMarkedObject_Trigger, 0 },
 	{ "lastpersontalkedto", GameScript::LastPersonTalkedTo, 0 }, //pst
 	{ "leaves", GameScript::Leaves, 0 },
-	{ "level", GameScript::Level, 0 },
-	{ "levelgt", GameScript::LevelGT, 0 },
+	{ "level", GameScript::Level, TF_PURE },
+	{ "levelgt", GameScript::LevelGT, TF_PURE },
 	{ "levelinclass", GameScript::LevelInClass, 0 }, //iwd2
 	{ "levelinclassgt", GameScript::LevelInClassGT, 0 },
 	{ "levelinclasslt", GameScript::LevelInClassLT, 0 },
-	{ "levellt", GameScript::LevelLT, 0 },
+	{ "levellt", GameScript::LevelLT, TF_PURE },
 	{ "levelparty", GameScript::LevelParty, 0 },
 	{ "levelpartygt", GameScript::LevelPartyGT, 0 },
 	{ "levelpartylt", GameScript::LevelPartyLT, 0 },
@@ -406,7 +409,7 @@ static const TriggerLink triggernames[] = {
 	{ "proficiency", GameScript::Proficiency, 0 },
 	{ "proficiencygt", GameScript::ProficiencyGT, 0 },
 	{ "proficiencylt", GameScript::ProficiencyLT, 0 },
-	{ "race", GameScript::Race, 0 },
+	{ "race", GameScript::Race, TF_PURE },
 	{ "randomnum", GameScript::RandomNum, 0 },
 	{ "randomnumgt", GameScript::RandomNumGT, 0 },
 	{ "randomnumlt", GameScript::RandomNumLT, 0 },
@@ -435,7 +438,7 @@ static const TriggerLink triggernames[] = {
 	{ "setlastmarkedobject", GameScript::SetLastMarkedObject, 0 },
 	{ "setmarkedspell", GameScript::SetMarkedSpell_Trigger, 0 },
 	{ "setspelltarget", GameScript::SetSpellTarget, 0 },
-	{ "specifics", GameScript::Specifics, 0 },
+	{ "specifics", GameScript::Specifics, TF_PURE },
 	{ "spellcast", GameScript::SpellCast, 0 },
 	{ "spellcastinnate", GameScript::SpellCastInnate, 0 },
 	{ "spellcastonme", GameScript::SpellCastOnMe, 0 },
@@ -1841,15 +1844,17 @@ Script* GameScript::CacheScript(const ResRef& resRef, bool AIScript)
 		return nullptr;
 	}
 
-	auto newScript = BcsCache.SetAt(resRef).first;
-
-	while (true) {
-		ResponseBlock* rB = ReadResponseBlock(stream);
-		if (!rB)
-			break;
-		newScript->responseBlocks.push_back(rB);
-		stream->ReadLine(line, 10);
-	}
+	Script* newScript = BcsCache.Load(resRef, [&](Script& script) {
+		while (true) {
+			ResponseBlock* rB = ReadResponseBlock(stream);
+			if (!rB)
+				break;
+			script.responseBlocks.push_back(rB);
+			stream->ReadLine(line, 10);
+		}
+		script.Compile();
+		return true;
+	});
 	delete stream;
 	return newScript;
 }
@@ -1880,7 +1885,7 @@ bool GameScript::Update(bool* continuing, bool* done)
 	RandomNumValue = RAND<int>();
 	for (size_t a = 0; a < script->responseBlocks.size(); a++) {
 		ResponseBlock* rB = script->responseBlocks[a];
-		if (!rB->condition->Evaluate(MySelf)) {
+		if (!script->EvaluateCondition(a, MySelf)) {
 			continue;
 		}
 
@@ -2026,21 +2031,210 @@ int GameScript::EvaluateString(Scriptable* Sender, const char* String)
 	return 0;
 }
 
-bool Condition::Evaluate(Scriptable* Sender) const
+// slots of the TF_PURE triggers, shared by all equal ones across the cached scripts
+static std::unordered_map<std::string, unsigned int> resultSlots;
+
+// results of the TF_PURE triggers, reused across the blocks and levels of one script pass
+// they're only valid until any action runs or another scriptable starts evaluating
+struct TriggerResult {
+	unsigned int pass = 0;
+	int result = 0;
+	ieDword lastTrigger = 0;
+};
+
+static const Scriptable* triggerResultsOwner = nullptr;
+static std::vector<TriggerResult> triggerResults;
+static unsigned int triggerResultsPass = 1;
+// marks that the trigger didn't set LastTrigger
+static constexpr ieDword NO_LAST_TRIGGER = 0xffffffff;
+
+void GameScript::ForgetTriggerResults()
+{
+	triggerResultsOwner = nullptr;
+	triggerResultsPass++;
+	if (!triggerResultsPass) {
+		triggerResults.clear();
+		triggerResultsPass = 1;
+	}
+}
+
+// object filters like LastTrigger or LastSeenBy depend on what the other triggers just did
+static bool IsStableObject(const Object* object)
+{
+	if (!object) return true;
+
+	for (int filter : object->objectFilters) {
+		if (!filter) break;
+		if (filter >= MAX_OBJECTS) return false;
+		ObjectFunction func = objects[filter];
+		if (func != GameScript::Myself && func != GameScript::Protagonist &&
+		    func != GameScript::Player1 && func != GameScript::Player2 && func != GameScript::Player3 &&
+		    func != GameScript::Player4 && func != GameScript::Player5 && func != GameScript::Player6) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// everything a pure trigger result depends on besides the sender, ignoring the negation
+static std::string TriggerKey(const Trigger& trigger)
+{
+	std::string key;
+	auto addValue = [&key](const auto& value) {
+		key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+	// the string parameters compare case insensitively
+	auto addString = [&key](const StringParam& str) {
+		for (char c : StringView(str)) {
+			key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+		}
+		key.push_back('\0');
+	};
+
+	addValue(trigger.triggerID);
+	addValue(trigger.flags & ~TF_NEGATE);
+	addValue(trigger.int0Parameter);
+	addValue(trigger.int1Parameter);
+	addValue(trigger.int2Parameter);
+	addValue(trigger.pointParameter.x);
+	addValue(trigger.pointParameter.y);
+	addString(trigger.string0Parameter);
+	addString(trigger.string1Parameter);
+
+	const Object* object = trigger.objectParameter;
+	if (!object) return key;
+
+	key.push_back('O');
+	for (int field : object->objectFields) {
+		addValue(field);
+	}
+	for (int filter : object->objectFilters) {
+		addValue(filter);
+	}
+	addValue(object->objectRect.x);
+	addValue(object->objectRect.y);
+	addValue(object->objectRect.w);
+	addValue(object->objectRect.h);
+	addString(object->objectName);
+	return key;
+}
+
+// only for diagnostics, the symbol lookup is too slow for every evaluation
+static StringView TriggerName(unsigned short triggerID)
+{
+	StringView name = triggersTable->GetValue(triggerID);
+	if (name.empty()) {
+		name = triggersTable->GetValue(triggerID | 0x4000);
+	}
+	return name;
+}
+
+
+static TriggerOp CompileTrigger(const Trigger* trigger)
+{
+	TriggerOp op;
+	op.trigger = trigger;
+	op.negate = trigger->flags & TF_NEGATE;
+
+	unsigned short triggerID = trigger->triggerID;
+	if (triggerID >= MAX_TRIGGERS) {
+		Log(ERROR, "GameScript", "Corrupted (too high) trigger code: {}", triggerID);
+		op.function = GameScript::False;
+		op.negate = false;
+		return op;
+	}
+	if (!triggers[triggerID]) {
+		triggers[triggerID] = GameScript::False;
+		Log(WARNING, "GameScript", "Unhandled trigger code: {:#x} {}",
+		    triggerID, TriggerName(triggerID));
+	}
+	op.function = triggers[triggerID];
+
+	if (triggerflags[triggerID] & TF_PURE && IsStableObject(trigger->objectParameter)) {
+		auto slot = resultSlots.emplace(TriggerKey(*trigger), static_cast<unsigned int>(resultSlots.size()));
+		op.resultSlot = slot.first->second;
+	}
+	return op;
+}
+
+void Script::Compile()
+{
+	conditionCode.clear();
+	blockCode.clear();
+	for (const ResponseBlock* rB : responseBlocks) {
+		blockCode.push_back(conditionCode.size());
+		if (!rB->condition) continue;
+
+		for (const Trigger* trigger : rB->condition->triggers) {
+			conditionCode.push_back(CompileTrigger(trigger));
+		}
+	}
+	blockCode.push_back(conditionCode.size());
+}
+
+static int RunTrigger(const TriggerOp& op, Scriptable* Sender)
+{
+	if (InDebugMode(DebugMode::TRIGGERS)) {
+		Log(DEBUG, "GameScript", "Executing trigger code: {:#x} {} (Sender: {} / {})", op.trigger->triggerID, TriggerName(op.trigger->triggerID), Sender->GetScriptName(), fmt::WideToChar { Sender->GetName() });
+	}
+
+	int ret = op.function(Sender, op.trigger);
+	return op.negate ? !ret : ret;
+}
+
+static int RunMemoized(const TriggerOp& op, Scriptable* Sender)
+{
+	if (op.resultSlot == TriggerOp::NO_RESULT_SLOT) {
+		return RunTrigger(op, Sender);
+	}
+
+	if (triggerResultsOwner != Sender) {
+		GameScript::ForgetTriggerResults();
+		triggerResultsOwner = Sender;
+	}
+	if (op.resultSlot >= triggerResults.size()) {
+		triggerResults.resize(resultSlots.size());
+	}
+
+	// pure triggers only return 0 or 1, so the negation can be applied on top
+	TriggerResult& known = triggerResults[op.resultSlot];
+	if (known.pass == triggerResultsPass) {
+		if (known.lastTrigger != NO_LAST_TRIGGER) {
+			Sender->objects.LastTrigger = known.lastTrigger;
+		}
+		return op.negate ? !known.result : known.result;
+	}
+
+	ieDword lastTrigger = Sender->objects.LastTrigger;
+	Sender->objects.LastTrigger = NO_LAST_TRIGGER;
+	int ret = RunTrigger(op, Sender);
+	known.pass = triggerResultsPass;
+	known.result = op.negate ? !ret : ret;
+	known.lastTrigger = Sender->objects.LastTrigger;
+	if (known.lastTrigger == NO_LAST_TRIGGER) {
+		Sender->objects.LastTrigger = lastTrigger;
+	}
+	return ret;
+}
+
+// combines the trigger results of a condition, taking care of Or() blocks
+template<typename Evaluator>
+static bool EvaluateTriggers(size_t count, Evaluator&& evaluate)
 {
 	int ORcount = 0;
 	unsigned int result = 0;
 	bool subresult = true;
 
-	if (triggers.empty()) {
+	if (!count) {
 		return true;
 	}
 
-	for (const Trigger* tR : triggers) {
+	static bool efficientOr = core->HasFeature(GFFlags::EFFICIENT_OR);
+	for (size_t i = 0; i < count; i++) {
 		//do not evaluate triggers in an Or() block if one of them
 		//was already True() ... but this sane approach was only used in iwd2!
-		if (!core->HasFeature(GFFlags::EFFICIENT_OR) || !ORcount || !subresult) {
-			result = tR->Evaluate(Sender);
+		if (!efficientOr || !ORcount || !subresult) {
+			result = evaluate(i);
 		}
 		if (result > 1) {
 			//we started an Or() block
@@ -2072,6 +2266,21 @@ bool Condition::Evaluate(Scriptable* Sender) const
 	return true;
 }
 
+bool Script::EvaluateCondition(size_t block, Scriptable* Sender) const
+{
+	size_t first = blockCode[block];
+	return EvaluateTriggers(blockCode[block + 1] - first, [&](size_t i) {
+		return RunMemoized(conditionCode[first + i], Sender);
+	});
+}
+
+bool Condition::Evaluate(Scriptable* Sender) const
+{
+	return EvaluateTriggers(triggers.size(), [&](size_t i) {
+		return triggers[i]->Evaluate(Sender);
+	});
+}
+
 /* this may return more than a boolean, in case of Or(x) */
 int Trigger::Evaluate(Scriptable* Sender) const
 {
@@ -2080,17 +2289,15 @@ int Trigger::Evaluate(Scriptable* Sender) const
 		return 0;
 	}
 	TriggerFunction func = triggers[triggerID];
-	StringView tmpstr = triggersTable->GetValue(triggerID);
-	if (tmpstr.empty()) {
-		tmpstr = triggersTable->GetValue(triggerID | 0x4000);
-	}
 	if (!func) {
 		triggers[triggerID] = GameScript::False;
 		Log(WARNING, "GameScript", "Unhandled trigger code: {:#x} {}",
-		    triggerID, tmpstr);
+		    triggerID, TriggerName(triggerID));
 		return 0;
 	}
-	ScriptDebugLog(DebugMode::TRIGGERS, "Executing trigger code: {:#x} {} (Sender: {} / {})", triggerID, tmpstr, Sender->GetScriptName(), fmt::WideToChar { Sender->GetName() });
+	if (InDebugMode(DebugMode::TRIGGERS)) {
+		Log(DEBUG, "GameScript", "Executing trigger code: {:#x} {} (Sender: {} / {})", triggerID, TriggerName(triggerID), Sender->GetScriptName(), fmt::WideToChar { Sender->GetName() });
+	}
 
 	int ret = func(Sender, this);
 	if (flags & TF_NEGATE) {
@@ -2154,7 +2361,7 @@ int Response::Execute(Scriptable* Sender)
 	int ret = 0; // continue or not
 	if (actions.empty()) return ret;
 
-	bool iwd2 = core->HasFeature(GFFlags::EFFICIENT_OR);
+	static bool iwd2 = core->HasFeature(GFFlags::EFFICIENT_OR);
 	const Action* last = actions.back();
 	bool hasContinue = false;
 	if (iwd2 && actionflags[last->actionID] & AF_CONTINUE) {
@@ -2243,6 +2450,7 @@ static bool CheckDeadException(const Scriptable* sender, int actionID)
 void GameScript::ExecuteAction(Scriptable* Sender, Action* aC)
 {
 	int actionID = aC->actionID;
+	ForgetTriggerResults();
 
 	// reallow area scripts after us, if they were disabled
 	if (aC->flags & ACF_REALLOW_SCRIPTS) {
@@ -361,6 +361,19 @@ public:
 	ResponseSet* responseSet = nullptr;
 };
 
+using TriggerFunction = int (*)(Scriptable*, const Trigger*);
+
+// one trigger of the flattened script conditions, with its function already looked up
+struct TriggerOp {
+	static constexpr unsigned int NO_RESULT_SLOT = 0xffffffff;
+
+	TriggerFunction function = nullptr;
+	const Trigger* trigger = nullptr;
+	bool negate = false;
+	// shared by all equal pure triggers, so their result can be reused during a script pass
+	unsigned int resultSlot = NO_RESULT_SLOT;
+};
+
 class GEM_EXPORT Script final : protected Canary {
 public:
 	~Script() noexcept override
@@ -374,6 +387,13 @@ public:
 	}
 
 	std::vector<ResponseBlock*> responseBlocks;
+	// the block conditions as one contiguous array, indexed by blockCode
+	std::vector<TriggerOp> conditionCode;
+	std::vector<size_t> blockCode; // start of each block, followed by the end
+
+	/** lowers the conditions once all the blocks were read */
+	void Compile();
+	bool EvaluateCondition(size_t block, Scriptable* Sender) const;
 
 	void Release()
 	{
@@ -381,7 +401,6 @@ public:
 	}
 };
 
-using TriggerFunction = int (*)(Scriptable*, const Trigger*);
 using ActionFunction = void (*)(Scriptable*, Action*);
 using ObjectFunction = Targets* (*) (const Scriptable*, Targets*, int ga_flags);
 using IDSFunction = int (*)(const Actor*, int parameter);
@@ -391,6 +410,7 @@ using IDSFunction = int (*)(const Actor*, int parameter);
 #define TF_SAVED        2 //trigger is in svtriobj.ids
 #define TF_MERGESTRINGS 8 //same value as actions' mergestring
 #define TF_HAS_OBJECT   16 // whether it has an object parameter
+#define TF_PURE         32 // no side effects besides LastTrigger, so the result can be reused during a script pass
 
 struct TriggerLink {
 	const char* Name;
@@ -502,6 +522,8 @@ public:
 	static void ExecuteString(Scriptable* Sender, std::string string);
 	static int EvaluateString(Scriptable* Sender, const char* String);
 	static void ExecuteAction(Scriptable* Sender, Action* aC);
+	/** drops the reusable trigger results, since the state they were based on could have changed */
+	static void ForgetTriggerResults();
 
 	bool Update(bool* continuing = NULL, bool* done = NULL);
 	void EvaluateAllBlocks(bool testConditions = false);
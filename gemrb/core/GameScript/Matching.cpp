@@ -33,6 +33,9 @@
 #include "Scriptable/Door.h"
 #include "Scriptable/InfoPoint.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace GemRB {
 
 /* return a Targets object with a single scriptable inside */
@@ -155,6 +158,69 @@ static inline bool DoObjectChecks(const Map* map, const Scriptable* Sender, Acto
 	return true;
 }
 
+// the IDS checks that only look at a single stat, so the area stat index can answer them
+static int IndexedStatOf(IDSFunction func)
+{
+	if (func == GameScript::ID_Allegiance) return IE_EA;
+	if (func == GameScript::ID_General) return IE_GENERAL;
+	if (func == GameScript::ID_Race) return IE_RACE;
+	if (func == GameScript::ID_Specific) return IE_SPECIFIC;
+	if (func == GameScript::ID_Gender) return IE_SEX;
+	if (func == GameScript::ID_Alignment) return IE_ALIGNMENT;
+	if (func == GameScript::ID_Subrace) return IE_SUBRACE;
+	if (func == GameScript::ID_Faction) return IE_FACTION;
+	if (func == GameScript::ID_Team) return IE_TEAM;
+	return -1;
+}
+
+// narrows the actors down to those passing the most selective indexed field
+// returns false if no field could use the index, so all actors need to be checked
+static bool GetIDSCandidates(const Map* map, const Object* oC, std::vector<int>& candidates)
+{
+	const ActorStatIndex& index = map->GetActorStatIndex();
+	// the stat is all that matters for these checks, so any actor of a bucket can stand in for the rest
+	auto passes = [map, oC](const ActorStatIndex::Bucket& bucket, int field) {
+		return idtargets[field](map->GetActor(bucket.actors[0], true), oC->objectFields[field]) != 0;
+	};
+
+	int bestField = -1;
+	size_t bestCount = 0;
+	for (int j = 0; j < ObjectIDSCount; j++) {
+		if (!oC->objectFields[j] || !idtargets[j]) continue;
+		int stat = IndexedStatOf(idtargets[j]);
+		if (stat < 0) continue;
+
+		size_t count = 0;
+		for (const auto& bucket : index.GetBuckets(stat)) {
+			if (passes(bucket, j)) count += bucket.actors.size();
+		}
+		if (bestField < 0 || count < bestCount) {
+			bestField = j;
+			bestCount = count;
+		}
+	}
+	if (bestField < 0) return false;
+
+	candidates.clear();
+	candidates.reserve(bestCount);
+	for (const auto& bucket : index.GetBuckets(IndexedStatOf(idtargets[bestField]))) {
+		if (!passes(bucket, bestField)) continue;
+		candidates.insert(candidates.end(), bucket.actors.begin(), bucket.actors.end());
+	}
+	// same order as going through all the actors
+	std::sort(candidates.begin(), candidates.end(), std::greater<int>());
+	return true;
+}
+
+static void AddIDSMatch(const Map* map, const Scriptable* Sender, const Object* oC, Actor* ac, int ga_flags, Targets*& tgts)
+{
+	int dist;
+	if (DoObjectChecks(map, Sender, ac, dist, (ga_flags & GA_DETECT) != 0, oC)) {
+		if (!tgts) tgts = new Targets();
+		tgts->AddTarget((Scriptable*) ac, dist, ga_flags);
+	}
+}
+
 /* returns actors that match the [x.y.z] expression */
 static Targets* EvaluateObject(const Map* map, const Scriptable* Sender, const Object* oC, int ga_flags)
 {
@@ -197,17 +263,32 @@ static Targets* EvaluateObject(const Map* map, const Scriptable* Sender, const O
 	}
 
 	Targets* tgts = NULL;
+	// don't return Sender in IDS targeting!
+	// unless it's pst, which relies on it in 3012cut2-3012cut7.bcs
+	// FIXME: stop abusing old GF flags
+	bool skipSender = !core->HasFeature(GFFlags::AREA_OVERRIDE);
 
 	//we need to get a subset of actors from the large array
-	//if this gets slow, we will need some index tables
+	//the area stat index takes care of it, unless only unindexed fields are set
+	std::vector<int> candidates;
+	if (GetIDSCandidates(map, oC, candidates)) {
+		for (int idx : candidates) {
+			Actor* ac = map->GetActor(idx, true);
+			if (skipSender && ac == Sender) continue;
+
+			bool filtered = false;
+			if (DoObjectIDSCheck(oC, ac, &filtered)) {
+				AddIDSMatch(map, Sender, oC, ac, ga_flags, tgts);
+			}
+		}
+		return tgts;
+	}
+
 	int i = map->GetActorCount(true);
 	while (i--) {
 		Actor* ac = map->GetActor(i, true);
 		if (!ac) continue; // is this check really needed?
-		// don't return Sender in IDS targeting!
-		// unless it's pst, which relies on it in 3012cut2-3012cut7.bcs
-		// FIXME: stop abusing old GF flags
-		if (!core->HasFeature(GFFlags::AREA_OVERRIDE) && ac == Sender) continue;
+		if (skipSender && ac == Sender) continue;
 
 		bool filtered = false;
 		if (!DoObjectIDSCheck(oC, ac, &filtered)) {
@@ -220,11 +301,7 @@ static Targets* EvaluateObject(const Map* map, const Scriptable* Sender, const O
 			assert(!tgts);
 			return nullptr;
 		}
-		int dist;
-		if (DoObjectChecks(map, Sender, ac, dist, (ga_flags & GA_DETECT) != 0, oC)) {
-			if (!tgts) tgts = new Targets();
-			tgts->AddTarget((Scriptable*) ac, dist, ga_flags);
-		}
+		AddIDSMatch(map, Sender, oC, ac, ga_flags, tgts);
 	}
 
 	return tgts;
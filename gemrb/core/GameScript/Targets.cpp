@@ -24,13 +24,72 @@
 #include "GameScript/GSUtils.h"
 #include "Strings/StringConversion.h"
 
+#include <algorithm>
+
 namespace GemRB {
 
+// enough for the nesting of object filters, anything beyond is just freed
+static constexpr size_t MAX_SPARE_TARGETS = 32;
+static std::vector<void*> spareObjects;
+static std::vector<targetlist> spareLists;
+
+void* Targets::operator new(size_t size)
+{
+	if (size != sizeof(Targets) || spareObjects.empty()) {
+		return ::operator new(size);
+	}
+	void* ptr = spareObjects.back();
+	spareObjects.pop_back();
+	return ptr;
+}
+
+void Targets::operator delete(void* ptr)
+{
+	if (!ptr) return;
+	if (spareObjects.size() < MAX_SPARE_TARGETS) {
+		spareObjects.push_back(ptr);
+	} else {
+		::operator delete(ptr);
+	}
+}
+
+Targets::Targets() noexcept
+{
+	if (!spareLists.empty()) {
+		objects = std::move(spareLists.back());
+		spareLists.pop_back();
+	}
+}
+
+Targets::~Targets()
+{
+	if (spareLists.size() < MAX_SPARE_TARGETS && objects.capacity()) {
+		objects.clear();
+		spareLists.push_back(std::move(objects));
+	}
+}
+
+// a stable sort keeps the targets at the same distance in the order they were added
+void Targets::Sort() const
+{
+	if (sorted) return;
+	std::stable_sort(objects.begin(), objects.end(), [](const targettype& a, const targettype& b) {
+		return a.distance < b.distance;
+	});
+	sorted = true;
+}
+
 size_t Targets::Count() const
 {
 	return objects.size();
 }
 
+void Targets::Pop()
+{
+	Sort();
+	objects.erase(objects.begin());
+}
+
 targettype* Targets::RemoveTargetAt(targetlist::iterator& m)
 {
 	m = objects.erase(m);
@@ -42,6 +101,7 @@ targettype* Targets::RemoveTargetAt(targetlist::iterator& m)
 
 const targettype* Targets::GetLastTarget(ScriptableType type)
 {
+	Sort();
 	targetlist::const_iterator m = objects.end();
 	while (m-- != objects.begin()) {
 		if (type == ST_ANY || (*m).actor->Type == type) {
@@ -53,6 +113,7 @@ const targettype* Targets::GetLastTarget(ScriptableType type)
 
 const targettype* Targets::GetFirstTarget(targetlist::iterator& m, ScriptableType type)
 {
+	Sort();
 	m = objects.begin();
 	while (m != objects.end()) {
 		if (type != ST_ANY && (*m).actor->Type != type) {
@@ -79,6 +140,7 @@ const targettype* Targets::GetNextTarget(targetlist::iterator& m, ScriptableType
 
 Scriptable* Targets::GetTarget(unsigned int index, ScriptableType type)
 {
+	Sort();
 	targetlist::iterator m = objects.begin();
 	while (m != objects.end()) {
 		if (type == ST_ANY || (*m).actor->Type == type) {
@@ -114,24 +176,22 @@ void Targets::AddTarget(Scriptable* target, unsigned int distance, int flags)
 			break;
 	}
 
-	targettype newTarget = { target, distance };
-	for (auto m = objects.begin(); m != objects.end(); ++m) {
-		if ((*m).distance > distance) {
-			objects.insert(m, newTarget);
-			return;
-		}
+	if (!objects.empty() && objects.back().distance > distance) {
+		sorted = false;
 	}
-	objects.push_back(newTarget);
+	objects.push_back({ target, distance });
 }
 
 void Targets::Clear()
 {
 	objects.clear();
+	sorted = true;
 }
 
 void Targets::dump() const
 {
 	Log(DEBUG, "GameScript", "Target dump (actors only):");
+	Sort();
 	for (const auto& object : objects) {
 		if (object.actor->Type == ST_ACTOR) {
 			Log(DEBUG, "GameScript", "{}", fmt::WideToChar { object.actor->GetName() });
@@ -144,13 +204,10 @@ void Targets::FilterObjectRect(const Object* oC)
 	// can't match anything if the second pair of coordinates (or all of them) are unset
 	if (oC->objectRect.w <= 0 || oC->objectRect.h <= 0) return;
 
-	for (auto m = objects.begin(); m != objects.end();) {
-		if (!IsInObjectRect((*m).actor->Pos, oC->objectRect)) {
-			m = objects.erase(m);
-		} else {
-			++m;
-		}
-	}
+	// the order is kept, so no need to sort first
+	objects.erase(std::remove_if(objects.begin(), objects.end(), [oC](const targettype& target) {
+		return !IsInObjectRect(target.actor->Pos, oC->objectRect);
+	}), objects.end());
 }
 
 }
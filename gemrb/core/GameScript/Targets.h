@@ -25,6 +25,8 @@
 
 #include "Scriptable/Scriptable.h"
 
+#include <vector>
+
 namespace GemRB {
 
 class Object;
@@ -34,16 +36,28 @@ struct targettype {
 	unsigned int distance;
 };
 
-using targetlist = std::list<targettype>;
+using targetlist = std::vector<targettype>;
 
+// short-lived and created for almost every object resolution, so both the objects
+// and their target buffers are recycled instead of going back to the heap
 class GEM_EXPORT Targets {
-	targetlist objects;
+	// kept in insertion order and only sorted by distance when read
+	mutable targetlist objects;
+	mutable bool sorted = true;
+
+	void Sort() const;
 
 public:
-	Targets() noexcept {};
+	Targets() noexcept;
+	Targets(const Targets&) = delete;
+	~Targets();
+	Targets& operator=(const Targets&) = delete;
+
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
 
 	size_t Count() const;
-	void Pop() { objects.pop_front(); };
+	void Pop();
 	targettype* RemoveTargetAt(targetlist::iterator& m);
 	const targettype* GetNextTarget(targetlist::iterator& m, ScriptableType type);
 	const targettype* GetLastTarget(ScriptableType type);
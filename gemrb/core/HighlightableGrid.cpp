@@ -0,0 +1,125 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "HighlightableGrid.h"
+
+#include "Scriptable/Container.h"
+#include "Scriptable/Door.h"
+#include "Scriptable/InfoPoint.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+void HighlightableGrid::Build(const Size& mapSize, const std::vector<Door*>& doors,
+			      const std::vector<Container*>& containers, const std::vector<InfoPoint*>& infoPoints)
+{
+	gridSize.w = std::max(1, (mapSize.w + CELL_SIZE - 1) / CELL_SIZE);
+	gridSize.h = std::max(1, (mapSize.h + CELL_SIZE - 1) / CELL_SIZE);
+	cells.assign(gridSize.Area(), {});
+	objects.clear();
+	unbounded.clear();
+
+	auto outlineBounds = [](const Highlightable* object, std::vector<Region>& bounds) {
+		bounds.push_back(object->BBox);
+		if (object->outline) {
+			bounds.push_back(object->outline->BBox);
+		}
+	};
+
+	std::vector<Region> bounds;
+	for (Door* door : doors) {
+		bounds.clear();
+		outlineBounds(door, bounds);
+		bounds.push_back(door->ClosedBBox);
+		for (bool open : { true, false }) {
+			auto trigger = door->doorTrigger.StatePolygon(open);
+			if (trigger) bounds.push_back(trigger->BBox);
+		}
+		Insert(door, uint32_t(objects.size()), bounds);
+	}
+	for (Container* container : containers) {
+		bounds.clear();
+		outlineBounds(container, bounds);
+		Insert(container, uint32_t(objects.size()), bounds);
+	}
+	for (InfoPoint* ip : infoPoints) {
+		bounds.clear();
+		outlineBounds(ip, bounds);
+		Insert(ip, uint32_t(objects.size()), bounds);
+	}
+}
+
+// objects off the map are kept at the edges
+int HighlightableGrid::CellX(int x) const
+{
+	return Clamp(x / CELL_SIZE, 0, gridSize.w - 1);
+}
+
+int HighlightableGrid::CellY(int y) const
+{
+	return Clamp(y / CELL_SIZE, 0, gridSize.h - 1);
+}
+
+void HighlightableGrid::Insert(Highlightable* object, uint32_t index, const std::vector<Region>& bounds)
+{
+	objects.push_back(object);
+
+	// the far edges are included, since polygon hit tests do so too
+	std::vector<int> marked;
+	for (const Region& box : bounds) {
+		if (box.w < 0 || box.h < 0) {
+			unbounded.push_back(index);
+			return;
+		}
+	}
+	for (const Region& box : bounds) {
+		for (int y = CellY(box.y); y <= CellY(box.y + box.h); ++y) {
+			for (int x = CellX(box.x); x <= CellX(box.x + box.w); ++x) {
+				int cell = y * gridSize.w + x;
+				if (std::find(marked.begin(), marked.end(), cell) != marked.end()) continue;
+				marked.push_back(cell);
+				cells[cell].push_back(index);
+			}
+		}
+	}
+}
+
+std::vector<Highlightable*> HighlightableGrid::Query(const Region& rgn) const
+{
+	std::vector<uint32_t> found = unbounded;
+	for (int y = CellY(rgn.y); y <= CellY(rgn.y + rgn.h); ++y) {
+		for (int x = CellX(rgn.x); x <= CellX(rgn.x + rgn.w); ++x) {
+			const auto& entries = cells[y * gridSize.w + x];
+			found.insert(found.end(), entries.begin(), entries.end());
+		}
+	}
+
+	std::sort(found.begin(), found.end());
+	found.erase(std::unique(found.begin(), found.end()), found.end());
+	std::vector<Highlightable*> result;
+	result.reserve(found.size());
+	for (uint32_t index : found) {
+		result.push_back(objects[index]);
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,65 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef HIGHLIGHTABLEGRID_H
+#define HIGHLIGHTABLEGRID_H
+
+#include "Region.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace GemRB {
+
+class Container;
+class Door;
+class Highlightable;
+class InfoPoint;
+
+/**
+ * Uniform grid over the navmap, bucketing the doors, containers and infopoints
+ * of an area by their bounds, so hover, click and rect queries only look at the
+ * objects nearby. The bounds cover every state a door can be in, so toggling it
+ * needs no update; only adding or removing objects needs a rebuild (see TileMap).
+ */
+class HighlightableGrid {
+public:
+	static constexpr int CELL_SIZE = 128; // in navmap pixels
+
+	void Build(const Size& mapSize, const std::vector<Door*>& doors,
+		   const std::vector<Container*>& containers, const std::vector<InfoPoint*>& infoPoints);
+
+	/** the objects whose bounds touch rgn: doors, then containers, then infopoints, each in list order */
+	std::vector<Highlightable*> Query(const Region& rgn) const;
+
+private:
+	Size gridSize;
+	std::vector<Highlightable*> objects; // in the order they are reported
+	std::vector<std::vector<uint32_t>> cells; // indices into objects
+	std::vector<uint32_t> unbounded; // no usable bounds, so they are reported for every query
+
+	void Insert(Highlightable* object, uint32_t index, const std::vector<Region>& bounds);
+	int CellX(int x) const;
+	int CellY(int y) const;
+};
+
+}
+
+#endif
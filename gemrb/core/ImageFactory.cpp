@@ -29,4 +29,13 @@ ImageFactory::ImageFactory(const ResRef& resref, Holder<Sprite2D> bitmap_)
 {
 }
 
+size_t ImageFactory::GetFootprint() const
+{
+	size_t size = sizeof(ImageFactory);
+	if (bitmap) {
+		size += sizeof(Sprite2D) + bitmap->Frame.w * bitmap->Frame.h * bitmap->Format().Bpp;
+	}
+	return size;
+}
+
 }
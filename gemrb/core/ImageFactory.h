@@ -36,6 +36,8 @@ public:
 	ImageFactory(const ResRef& resref, Holder<Sprite2D> bitmap);
 
 	Holder<Sprite2D> GetSprite2D() const { return bitmap; }
+	size_t GetFootprint() const override;
+	bool InUse() const override { return bitmap.use_count() > 1; }
 };
 
 }
@@ -65,6 +65,9 @@
 #include "GameScript/GameScript.h"
 #include "Scriptable/Container.h"
 #include "Streams/FileStream.h"
+#if defined(SUPPORTS_MEMSTREAM)
+	#include "Streams/MappedFileMemoryStream.h"
+#endif
 #include "System/FileFilters.h"
 #include "Video/Video.h"
 
@@ -89,6 +92,19 @@ static void ThrowException(const std::string& msg)
 	throw CIE(msg);
 }
 
+// strings are looked up all the time, so the tlk is mapped when possible
+static DataStream* OpenTLK(const path_t& path)
+{
+	if (!FileExists(path)) return nullptr;
+
+#if defined(SUPPORTS_MEMSTREAM)
+	auto mapped = new MappedFileMemoryStream { path };
+	if (mapped->isOk()) return mapped;
+	delete mapped;
+#endif
+	return FileStream::OpenFile(path);
+}
+
 struct AbilityTables {
 	using AbilityTable = std::vector<ieWordSigned>;
 
@@ -263,6 +279,8 @@ Interface::Interface(CoreSettings&& cfg)
 	EventMgr::TouchInputEnabled = config.TouchInput < 0 ? VideoDriver->TouchInputEnabled() : config.TouchInput;
 	EventMgr::DCDelay = config.DoubleClickDelay;
 	Control::ActionRepeatDelay = config.ActionRepeatDelay;
+	Map::ScriptBudget = std::max(0, config.ScriptBudget);
+	gamedata->SetFactoryBudget(size_t(std::max(0, config.AnimationCacheSize)) * 1024 * 1024);
 	GameControl::DebugFlags = config.DebugFlags;
 
 	Log(MESSAGE, "Core", "Initializing search path...");
@@ -271,10 +289,14 @@ Interface::Interface(CoreSettings&& cfg)
 	}
 
 	path_t path = config.CachePath;
-	if (!gamedata->AddSource(path, "Cache", PLUGIN_RESOURCE_DIRECTORY)) {
+	if (!gamedata->AddSource(path, "Cache", PLUGIN_RESOURCE_DIRECTORY, RM_VOLATILE_SOURCE)) {
 		ThrowException("The cache path couldn't be registered, please check!");
 	}
 
+	if (config.PreloadAreas) {
+		gamedata->EnableAreaPreloading();
+	}
+
 	for (const auto& modPath : config.ModPath) {
 		gamedata->AddSource(modPath, "Mod paths", PLUGIN_RESOURCE_CACHEDDIRECTORY);
 	}
@@ -448,12 +470,12 @@ Interface::Interface(CoreSettings&& cfg)
 	strings = MakePluginHolder<StringMgr>(IE_TLK_CLASS_ID);
 	Log(MESSAGE, "Core", "Loading Dialog.tlk file...");
 	path_t strpath = PathJoin(config.GamePath, "dialog.tlk");
-	FileStream* fs = FileStream::OpenFile(strpath);
+	DataStream* fs = OpenTLK(strpath);
 
 	if (!fs) {
 		// EE multi language deployment
 		strpath = PathJoin(config.GamePath, config.GameLanguagePath, "dialog.tlk");
-		fs = FileStream::OpenFile(strpath);
+		fs = OpenTLK(strpath);
 
 		if (!fs) {
 			ThrowException("Cannot find Dialog.tlk.");
@@ -466,11 +488,11 @@ Interface::Interface(CoreSettings&& cfg)
 		strings2 = MakePluginHolder<StringMgr>(IE_TLK_CLASS_ID);
 		Log(MESSAGE, "Core", "Loading DialogF.tlk file...");
 		strpath = PathJoin(config.GamePath, "dialogf.tlk");
-		fs = FileStream::OpenFile(strpath);
+		fs = OpenTLK(strpath);
 		if (!fs) {
 			// try EE-style paths
 			strpath = PathJoin(config.GamePath, config.GameLanguagePath, "dialogf.tlk");
-			fs = FileStream::OpenFile(strpath);
+			fs = OpenTLK(strpath);
 		}
 		if (!fs) {
 			Log(ERROR, "Core", "Cannot find DialogF.tlk. Let us know which translation you are using.");
@@ -3341,8 +3363,9 @@ bool Interface::ResolveRandomItem(CREItem* itm) const
 				return false;
 			}
 			// try detecting malformed / placeholder items, present in iwd2
+			bool valid = item->ItemName != ieStrRef::INVALID || item->ItemNameIdentified != ieStrRef::INVALID || item->ItemType || item->GetExtHeader(0);
 			gamedata->FreeItem(item, itm->ItemResRef, false);
-			return item->ItemName != ieStrRef::INVALID || item->ItemNameIdentified != ieStrRef::INVALID || item->ItemType || item->GetExtHeader(0);
+			return valid;
 		}
 
 		ResRef pickedItem = pickFromRow(itm->ItemResRef);
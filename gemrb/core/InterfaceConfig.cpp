@@ -158,6 +158,7 @@ CoreSettings LoadFromDictionary(InterfaceConfig cfg)
 		}
 	};
 
+	CONFIG_INT("AnimationCacheSize", config.AnimationCacheSize);
 	CONFIG_INT("Bpp", config.Bpp);
 	CONFIG_INT("CaseSensitive", config.CaseSensitive);
 	CONFIG_INT("DoubleClickDelay", config.DoubleClickDelay);
@@ -173,9 +174,12 @@ CoreSettings LoadFromDictionary(InterfaceConfig cfg)
 	config.MaxPartySize = std::min(std::max(1, config.MaxPartySize), 10);
 	CONFIG_INT("MouseFeedback", config.MouseFeedback);
 	CONFIG_INT("MultipleQuickSaves", config.MultipleQuickSaves);
+	CONFIG_INT("PrecacheArchives", config.PrecacheArchives);
+	CONFIG_INT("PreloadAreas", config.PreloadAreas);
 	CONFIG_INT("UseAsLibrary", config.UseAsLibrary);
 	CONFIG_INT("RepeatKeyDelay", config.ActionRepeatDelay);
 	CONFIG_INT("SaveAsOriginal", config.SaveAsOriginal);
+	CONFIG_INT("ScriptBudget", config.ScriptBudget);
 	CONFIG_INT("SpriteFogOfWar", config.SpriteFoW);
 	CONFIG_INT("DebugMode", config.debugMode);
 	CONFIG_INT("TouchInput", config.TouchInput);
@@ -104,6 +104,8 @@ struct CoreSettings {
 	int GUIEnhancements = 23;
 
 	bool KeepCache = false;
+	bool PrecacheArchives = false;
+	bool PreloadAreas = true;
 	bool MultipleQuickSaves = false;
 	bool UseAsLibrary = false;
 	// once GemRB own format is working well, this might be set to 0
@@ -116,6 +118,8 @@ struct CoreSettings {
 	int DoubleClickDelay = 250;
 	uint32_t DebugFlags = 0;
 	uint32_t ActionRepeatDelay = 250;
+	int ScriptBudget = 10;
+	int AnimationCacheSize = 32; // in megabytes
 	int TouchInput = -1;
 	std::string SystemEncoding = "UTF-8";
 	std::string ScaleQuality = "best";
@@ -1399,19 +1399,27 @@ void Inventory::CacheAllWeaponInfo() const
 		CacheWeaponInfo(true);
 	} else {
 		WeaponInfo& wi = Owner->weaponInfo[1];
-		wi.extHeader = nullptr;
-		wi.item = nullptr;
+		ReleaseWeaponInfo(wi);
 		wi.wflags = 0;
 	}
 }
 
+// the cached item is referenced for as long as the info points into it
+void Inventory::ReleaseWeaponInfo(WeaponInfo& wi)
+{
+	if (wi.item) {
+		gamedata->FreeItem(wi.item, wi.item->Name, false);
+	}
+	wi.extHeader = nullptr;
+	wi.item = nullptr;
+}
+
 void Inventory::CacheWeaponInfo(bool leftOrRight) const
 {
 	WeaponInfo& wi = Owner->weaponInfo[leftOrRight];
 	wi.slot = GetEquippedSlot();
 	bool ranged = (core->QuerySlotEffects(wi.slot) & SLOT_EFFECT_MISSILE) == SLOT_EFFECT_MISSILE; // detect ammo slot
-	wi.extHeader = nullptr; // for the error paths; properly set at the end
-	wi.item = nullptr;
+	ReleaseWeaponInfo(wi); // for the error paths; properly set at the end
 	wi.wflags = 0;
 
 	const CREItem* weapon;
@@ -1505,10 +1513,8 @@ void Inventory::CacheWeaponInfo(bool leftOrRight) const
 		}
 	}
 
-	// make sure we use 'false' in this FreeItem
-	// so the extended header won't point into invalid memory
-	gamedata->FreeItem(item, weapon->ItemResRef, false);
-
+	// the reference is kept in wi.item, so the extended header stays valid
+	// until ReleaseWeaponInfo
 	// these flags are set by the launcher, not ammo
 	if (hittingHeader->RechargeFlags & IE_ITEM_USESTRENGTH) wi.wflags |= WEAPON_USESTRENGTH;
 	if (hittingHeader->RechargeFlags & IE_ITEM_USESTRENGTH_DMG) wi.wflags |= WEAPON_USESTRENGTH_DMG;
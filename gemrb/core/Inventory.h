@@ -41,6 +41,7 @@ namespace GemRB {
 class ITMExtHeader;
 class Item;
 class Map;
+struct WeaponInfo;
 
 //AddSlotItem return values
 #define ASI_FAILED  0
@@ -359,6 +360,7 @@ public:
 	static int GetInventorySlot();
 	int InBackpack(int slot) const;
 	void CacheAllWeaponInfo() const;
+	static void ReleaseWeaponInfo(WeaponInfo& wi);
 	void EnforceUsability();
 
 private:
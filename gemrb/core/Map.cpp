@@ -60,7 +60,12 @@
 
 namespace GemRB {
 
-static constexpr unsigned int MAX_CIRCLESIZE = 8;
+static constexpr unsigned int MAX_CIRCLESIZE = ClearanceMap::MAX_SIZE;
+// shorter sight lines are cheaper to walk than to look up
+static constexpr int LOS_CACHE_MIN_DISTANCE = 8;
+static constexpr size_t LOS_CACHE_SIZE = 64 * 1024;
+
+tick_t Map::ScriptBudget = 10;
 
 const PixelFormat TileProps::pixelFormat(0, 0, 0, 0,
 					 searchMapShift, materialMapShift,
@@ -441,6 +446,9 @@ Map::Map(TileMap* tm, TileProps props, Holder<Sprite2D> sm)
 {
 	area = this;
 	MasterArea = core->GetGame()->MasterArea(scriptName);
+	pathfinderHierarchy.Build(tileProps);
+	clearanceMap.Build(tileProps);
+	actorGrid.Resize(Size(PropsSize().w * 16, PropsSize().h * 12));
 }
 
 Map::~Map(void)
@@ -489,6 +497,19 @@ Map::~Map(void)
 void Map::SetTileMapProps(TileProps props)
 {
 	tileProps = std::move(props);
+	pathfinderHierarchy.Build(tileProps);
+	clearanceMap.Build(tileProps);
+	losCache.clear();
+}
+
+void Map::InvalidatePathfinderData(const SearchmapPoint& p)
+{
+	pathfinderHierarchy.Invalidate(p);
+	clearanceMap.Invalidate(p);
+	// doors call this once per impeded cell
+	if (!losCache.empty()) {
+		losCache.clear();
+	}
 }
 
 const MapReverbProperties& Map::GetReverbProperties() const
@@ -723,6 +744,7 @@ void Map::UpdateScripts()
 	}
 
 	ieDword time = game->Ticks; // make sure everything moves at the same time
+	scriptDeadline = ScriptBudget ? GetMilliseconds() + ScriptBudget : 0;
 
 	//Run actor scripts (only for 0 priority)
 	const auto& runQueue = queue[int(Priority::RunScripts)];
@@ -824,6 +846,7 @@ void Map::UpdateScripts()
 	}
 
 	//Check if we need to start some trap scripts
+	std::unordered_map<const Actor*, size_t> runOrder;
 	int ipCount = 0;
 	while (true) {
 		//For each InfoPoint in the map
@@ -844,21 +867,25 @@ void Map::UpdateScripts()
 		if (ip->Type == ST_TRIGGER) {
 			ip->Update();
 			continue;
+		} else if (ip->Type == ST_TRAVEL) {
+			PreloadExit(ip, time);
 		}
 
-		const auto& runQueue = queue[int(Priority::RunScripts)];
-		q = runQueue.size();
-		ieDword exitID = ip->GetGlobalID();
-		while (q--) {
-			Actor* actor = runQueue[q];
-			if (ip->Type == ST_PROXIMITY) {
+		if (ip->Type == ST_PROXIMITY) {
+			for (Actor* actor : GetTrapEntrants(ip, runOrder)) {
 				if (ip->Entered(actor)) {
 					// if trap triggered, then mark actor
 					actor->SetInTrap(ipCount);
 					wasActive |= _TRAP_USEPOINT;
 				}
-			} else {
-				// ST_TRAVEL
+			}
+		} else {
+			// ST_TRAVEL
+			const auto& runQueue = queue[int(Priority::RunScripts)];
+			q = runQueue.size();
+			ieDword exitID = ip->GetGlobalID();
+			while (q--) {
+				Actor* actor = runQueue[q];
 				// don't move if doing something else
 				// added CurrentAction as part of blocking action fixes
 				if (actor->CannotPassEntrance(exitID)) {
@@ -889,6 +916,66 @@ void Map::UpdateScripts()
 	SortQueues();
 }
 
+// start reading the destination in the background, so the transition itself is quicker
+void Map::PreloadExit(const InfoPoint* ip, ieDword time) const
+{
+	// once per second is plenty
+	if (ip->Destination.IsEmpty() || time % core->Time.defaultTicksPerSec) {
+		return;
+	}
+
+	Region vicinity = ip->BBox;
+	vicinity.ExpandAllSides(PRELOAD_EXIT_RANGE);
+	for (const auto& actor : actors) {
+		if (actor->InParty && vicinity.PointInside(actor->Pos)) {
+			gamedata->PreloadArea(ip->Destination);
+			return;
+		}
+	}
+}
+
+// the scripted actors that can be in reach of the trap, in the same (reverse) order as the run queue
+// proximity traps only check the outline and the use point, so the rest of the area can be skipped
+std::vector<Actor*> Map::GetTrapEntrants(const InfoPoint* ip, std::unordered_map<const Actor*, size_t>& runOrder) const
+{
+	const auto& runQueue = queue[int(Priority::RunScripts)];
+	if (runOrder.empty()) {
+		for (size_t i = 0; i < runQueue.size(); ++i) {
+			runOrder[runQueue[i]] = i;
+		}
+	}
+
+	std::vector<Actor*> nearby;
+	if (ip->outline) {
+		nearby = actorGrid.Query(ip->outline->BBox);
+	} else if (!ip->BBox.size.IsInvalid()) {
+		nearby = actorGrid.Query(ip->BBox);
+	}
+	if (ip->GetUsePoint()) {
+		std::vector<Actor*> nearUsePoint = actorGrid.Query(ip->UsePoint, MAX_OPERATING_DISTANCE);
+		nearby.insert(nearby.end(), nearUsePoint.begin(), nearUsePoint.end());
+	}
+
+	std::vector<std::pair<size_t, Actor*>> entrants;
+	for (Actor* actor : nearby) {
+		auto order = runOrder.find(actor);
+		if (order != runOrder.end()) {
+			entrants.emplace_back(order->second, actor);
+		}
+	}
+	std::sort(entrants.begin(), entrants.end(), [](const auto& a, const auto& b) {
+		return a.first > b.first;
+	});
+	entrants.erase(std::unique(entrants.begin(), entrants.end()), entrants.end());
+
+	std::vector<Actor*> entrantActors;
+	entrantActors.reserve(entrants.size());
+	for (const auto& entrant : entrants) {
+		entrantActors.push_back(entrant.second);
+	}
+	return entrantActors;
+}
+
 ResRef Map::ResolveTerrainSound(const ResRef& resref, const Point& p) const
 {
 	struct TerrainSounds {
@@ -1894,7 +1981,7 @@ int Map::CountSummons(ieDword flags, ieDword sex) const
 bool Map::AnyEnemyNearPoint(const Point& p) const
 {
 	ieDword gametime = core->GetGame()->GameTime;
-	for (const Actor* actor : actors) {
+	for (const Actor* actor : actorGrid.Query(p, SPAWN_RANGE)) {
 		if (!actor->Schedule(gametime, true)) {
 			continue;
 		}
@@ -1980,6 +2067,8 @@ void Map::AddActor(Actor* actor, bool init)
 	actor->AreaName = scriptName;
 	if (!HasActor(actor)) {
 		actors.push_back(actor);
+		actorGrid.Insert(actor);
+		statIndex.Invalidate();
 	}
 	if (init) {
 		actor->SetMap(this);
@@ -2026,82 +2115,56 @@ void Map::DeleteActor(size_t idx)
 		}
 	}
 	//remove the actor from the area's actor list
+	actorGrid.Remove(actors[idx]);
 	actors.erase(actors.begin() + idx);
+	statIndex.Invalidate();
 }
 
 Scriptable* Map::GetScriptableByGlobalID(ieDword objectID)
 {
-	if (!objectID) return nullptr;
-
-	Scriptable* scr = GetActorByGlobalID(objectID);
-	if (scr)
-		return scr;
-
-	scr = GetInfoPointByGlobalID(objectID);
-	if (scr)
-		return scr;
-
-	scr = GetContainerByGlobalID(objectID);
-	if (scr)
-		return scr;
-
-	scr = GetDoorByGlobalID(objectID);
-	if (scr)
-		return scr;
-
-	if (GetGlobalID() == objectID)
-		scr = this;
-
-	return scr;
+	Scriptable* scr = Scriptable::FindByGlobalID(objectID);
+	if (!scr) return nullptr;
+
+	switch (scr->Type) {
+		case ST_ACTOR:
+			return GetActorByGlobalID(objectID);
+		case ST_PROXIMITY:
+		case ST_TRIGGER:
+		case ST_TRAVEL:
+			return GetInfoPointByGlobalID(objectID);
+		case ST_CONTAINER:
+			return GetContainerByGlobalID(objectID);
+		case ST_DOOR:
+			return GetDoorByGlobalID(objectID);
+		default:
+			return scr == this ? scr : nullptr;
+	}
 }
 
+// the registry knows them all, but we only want our own
 Door* Map::GetDoorByGlobalID(ieDword objectID) const
 {
-	if (!objectID) return nullptr;
-
-	for (const auto& door : area->TMap->GetDoors()) {
-		if (door->GetGlobalID() == objectID) {
-			return door;
-		}
-	}
-	return nullptr;
+	Door* door = Scriptable::As<Door>(Scriptable::FindByGlobalID(objectID));
+	return door && door->GetCurrentArea() == this ? door : nullptr;
 }
 
 Container* Map::GetContainerByGlobalID(ieDword objectID) const
 {
-	if (!objectID) return nullptr;
-
-	for (const auto& container : area->TMap->GetContainers()) {
-		if (container->GetGlobalID() == objectID) {
-			return container;
-		}
-	}
-	return nullptr;
+	Container* container = Scriptable::As<Container>(Scriptable::FindByGlobalID(objectID));
+	return container && container->GetCurrentArea() == this ? container : nullptr;
 }
 
 InfoPoint* Map::GetInfoPointByGlobalID(ieDword objectID) const
 {
-	if (!objectID) return nullptr;
-
-	for (const auto& ip : TMap->GetInfoPoints()) {
-		if (ip->GetGlobalID() == objectID) {
-			return ip;
-		}
-	}
-	return nullptr;
+	InfoPoint* ip = Scriptable::As<InfoPoint>(Scriptable::FindByGlobalID(objectID));
+	return ip && ip->GetCurrentArea() == this ? ip : nullptr;
 }
 
 Actor* Map::GetActorByGlobalID(ieDword objectID) const
 {
-	if (!objectID) {
-		return nullptr;
-	}
-	for (const auto& actor : actors) {
-		if (actor->GetGlobalID() == objectID) {
-			return actor;
-		}
-	}
-	return nullptr;
+	Actor* actor = Scriptable::As<Actor>(Scriptable::FindByGlobalID(objectID));
+	// actors can be listed here before they get their area
+	return actor && HasActor(actor) ? actor : nullptr;
 }
 
 /** flags:
@@ -2115,16 +2178,8 @@ Scriptable* Map::GetScriptable(const Point& p, int flags, const Movable* checker
 	auto actor = GetActor(p, flags, checker);
 	if (actor) return actor;
 
-	for (const auto& door : TMap->GetDoors()) {
-		if (door->IsOver(p)) return door;
-	}
-
-	for (const auto& cont : TMap->GetContainers()) {
-		if (cont->IsOver(p)) return cont;
-	}
-
-	for (const auto& ip : TMap->GetInfoPoints()) {
-		if (ip->IsOver(p)) return ip;
+	for (const auto& object : TMap->GetObjectsNear(Region(p, Size()))) {
+		if (object->IsOver(p)) return object;
 	}
 
 	return nullptr;
@@ -2140,23 +2195,15 @@ std::vector<Scriptable*> Map::GetScriptablesInRect(const Point& p, unsigned int
 	rect.y += radius / 4;
 	rect.h -= radius / 2;
 
-	for (const auto& door : TMap->GetDoors()) {
-		if (door->BBox.IntersectsRegion(rect)) neighbours.emplace_back(door);
-	}
-
-	for (const auto& cont : TMap->GetContainers()) {
-		if (cont->BBox.IntersectsRegion(rect)) neighbours.emplace_back(cont);
-	}
-
-	for (const auto& ip : TMap->GetInfoPoints()) {
-		if (ip->BBox.IntersectsRegion(rect)) neighbours.emplace_back(ip);
+	for (const auto& object : TMap->GetObjectsNear(rect)) {
+		if (object->BBox.IntersectsRegion(rect)) neighbours.emplace_back(object);
 	}
 	return neighbours;
 }
 
 Actor* Map::GetActor(const Point& p, int flags, const Movable* checker) const
 {
-	for (auto actor : actors) {
+	for (auto actor : actorGrid.Query(p, 0)) {
 		if (!actor->IsOver(p))
 			continue;
 		if (!actor->ValidTarget(flags, checker)) {
@@ -2169,7 +2216,7 @@ Actor* Map::GetActor(const Point& p, int flags, const Movable* checker) const
 
 Actor* Map::GetActorInRadius(const Point& p, int flags, unsigned int radius, const Scriptable* checker) const
 {
-	for (auto actor : actors) {
+	for (auto actor : actorGrid.Query(p, radius)) {
 		if (PersonalDistance(p, actor) > radius)
 			continue;
 		if (!actor->ValidTarget(flags, checker)) {
@@ -2183,7 +2230,8 @@ Actor* Map::GetActorInRadius(const Point& p, int flags, unsigned int radius, con
 std::vector<Actor*> Map::GetAllActorsInRadius(const Point& p, int flags, unsigned int radius, const Scriptable* see) const
 {
 	std::vector<Actor*> neighbours;
-	for (auto actor : actors) {
+	// the radius is in feet, see Feet2Pixels
+	for (auto actor : actorGrid.Query(p, 16 * radius)) {
 		if (!WithinRange(actor, p, radius)) {
 			continue;
 		}
@@ -2215,6 +2263,14 @@ Actor* Map::GetActor(const ieVariable& Name, int flags) const
 	return nullptr;
 }
 
+const ActorStatIndex& Map::GetActorStatIndex() const
+{
+	if (statIndex.IsDirty()) {
+		statIndex.Build(actors);
+	}
+	return statIndex;
+}
+
 int Map::GetActorCount(bool any) const
 {
 	if (any) {
@@ -2424,8 +2480,7 @@ Actor* Map::GetActorByScriptName(const ieVariable& name) const
 std::vector<Actor*> Map::GetActorsInRect(const Region& rgn, int excludeFlags) const
 {
 	std::vector<Actor*> actorlist;
-	actorlist.reserve(actors.size());
-	for (auto actor : actors) {
+	for (auto actor : actorGrid.Query(rgn)) {
 		if (!actor->ValidTarget(excludeFlags))
 			continue;
 		if (!rgn.PointInside(actor->Pos) && !actor->IsOver(rgn.origin)) // imagine drawing a tiny box inside the circle, but not over the center
@@ -2578,13 +2633,21 @@ PathMapFlags Map::GetBlockedInRadiusTile(const SearchmapPoint& tp, uint16_t size
 	size = Clamp<uint16_t>(size, 2, MAX_CIRCLESIZE);
 	uint16_t r = size - 2;
 
-	std::vector<BasePoint> points;
-	if (r == 0) { // avoid generating 16 identical points
-		points.push_back(tp);
-		points.push_back(tp);
-	} else {
-		points = PlotCircle(tp, r);
+	if (stopOnImpassable && clearanceMap.HitsImpassable(tp, size)) {
+		return PathMapFlags::IMPASSABLE;
 	}
+
+	// the circle spans only depend on the radius, so they're shared
+	static const auto circles = []() {
+		std::array<std::vector<BasePoint>, MAX_CIRCLESIZE - 1> spans;
+		spans[0] = { BasePoint(), BasePoint() }; // avoid generating 16 identical points
+		for (uint16_t radius = 1; radius < spans.size(); ++radius) {
+			spans[radius] = PlotCircle(BasePoint(), radius);
+		}
+		return spans;
+	}();
+
+	const auto& points = circles[r];
 	for (size_t i = 0; i < points.size(); i += 2) {
 		const BasePoint& p1 = points[i];
 		const BasePoint& p2 = points[i + 1];
@@ -2592,7 +2655,7 @@ PathMapFlags Map::GetBlockedInRadiusTile(const SearchmapPoint& tp, uint16_t size
 		assert(p2.x <= p1.x);
 
 		for (int x = p2.x; x <= p1.x; ++x) {
-			PathMapFlags flags = GetBlockedTile(SearchmapPoint(x, p1.y));
+			PathMapFlags flags = GetBlockedTile(SearchmapPoint(tp.x + x, tp.y + p1.y));
 			if (stopOnImpassable && flags == PathMapFlags::IMPASSABLE) {
 				return PathMapFlags::IMPASSABLE;
 			}
@@ -2618,7 +2681,7 @@ PathMapFlags Map::GetBlockedInLine(const NavmapPoint& s, const NavmapPoint& d, b
 	float_t factor = caller && caller->GetSpeed() ? float_t(gamedata->GetStepTime()) / float_t(caller->GetSpeed()) : 1;
 
 	const int circleSize = caller ? caller->circleSize : 0;
-	const auto getBlockedStatusFn = (stopOnImpassable && caller) ? &Map::GetChildBlockedStatusForBigSize : &Map::GetChildBlockedStatusForSmallSize;
+	const auto getBlockedStatusFn = (stopOnImpassable && caller) ? &Map::GetLineBlockedStatusForBigSize : &Map::GetChildBlockedStatusForSmallSize;
 	while (p != d) {
 		float_t dx = d.x - p.x;
 		float_t dy = d.y - p.y;
@@ -2652,7 +2715,7 @@ PathMapFlags Map::GetBlockedInLineTile(const SearchmapPoint& s, const SearchmapP
 	float_t factor = caller && caller->GetSpeed() ? float_t(gamedata->GetStepTime()) / float_t(caller->GetSpeed()) / 16 : 1;
 
 	const int circleSize = caller ? caller->circleSize : 0;
-	const auto getBlockedStatusFn = (stopOnImpassable && caller) ? &Map::GetChildBlockedStatusForBigSize : &Map::GetChildBlockedStatusForSmallSize;
+	const auto getBlockedStatusFn = (stopOnImpassable && caller) ? &Map::GetLineBlockedStatusForBigSize : &Map::GetChildBlockedStatusForSmallSize;
 	while (p != d) {
 		float_t dx = d.x - p.x;
 		float_t dy = d.y - p.y;
@@ -2682,14 +2745,63 @@ PathMapFlags Map::GetBlockedInLineTile(const SearchmapPoint& s, const SearchmapP
 // PathMapFlags::SIDEWALL obstructs LOS, while PathMapFlags::IMPASSABLE doesn't
 bool Map::IsVisibleLOS(const Point& s, const Point& d, const Actor* caller) const
 {
-	PathMapFlags ret = GetBlockedInLine(s, d, false, caller);
-	return !bool(ret & PathMapFlags::SIDEWALL);
+	return IsVisibleLOS(SearchmapPoint(s), SearchmapPoint(d), caller);
 }
 
-bool Map::IsVisibleLOS(const SearchmapPoint& s, const SearchmapPoint& d, const Actor* caller) const
+// sight only depends on the cells, not on who is looking, so the longer lines are cached
+bool Map::IsVisibleLOS(const SearchmapPoint& s, const SearchmapPoint& d, const Actor* /*caller*/) const
 {
-	PathMapFlags ret = GetBlockedInLineTile(s, d, false, caller);
-	return !bool(ret & PathMapFlags::SIDEWALL);
+	const Size& mapSize = PropsSize();
+	if (std::abs(d.x - s.x) + std::abs(d.y - s.y) < LOS_CACHE_MIN_DISTANCE || !mapSize.PointInside(s) || !mapSize.PointInside(d)) {
+		return !IsSightBlockedInLine(s, d);
+	}
+
+	uint64_t key = uint64_t(s.y * mapSize.w + s.x) << 32 | uint32_t(d.y * mapSize.w + d.x);
+	auto cached = losCache.find(key);
+	if (cached != losCache.end()) {
+		return cached->second;
+	}
+
+	if (losCache.size() >= LOS_CACHE_SIZE) {
+		losCache.clear();
+	}
+	bool visible = !IsSightBlockedInLine(s, d);
+	losCache.emplace(key, visible);
+	return visible;
+}
+
+// walks all the cells crossed by the line between the cell centers, except the first one
+// it's only corners that are passed diagonally, like the stepping of GetBlockedInLine does
+bool Map::IsSightBlockedInLine(const SearchmapPoint& s, const SearchmapPoint& d) const
+{
+	const int nx = std::abs(d.x - s.x);
+	const int ny = std::abs(d.y - s.y);
+	const int signX = d.x > s.x ? 1 : -1;
+	const int signY = d.y > s.y ? 1 : -1;
+
+	SearchmapPoint p = s;
+	for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+		// which cell border the line reaches first
+		int decision = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+		if (decision == 0) {
+			p.x += signX;
+			p.y += signY;
+			++ix;
+			++iy;
+		} else if (decision < 0) {
+			p.x += signX;
+			++ix;
+		} else {
+			p.y += signY;
+			++iy;
+		}
+
+		PathMapFlags flags = tileProps.QuerySearchMap(p);
+		if (bool(flags & (PathMapFlags::SIDEWALL | PathMapFlags::DOOR_OPAQUE))) {
+			return true;
+		}
+	}
+	return false;
 }
 
 // Used by the pathfinder, so PathMapFlags::IMPASSABLE obstructs walkability
@@ -2951,12 +3063,7 @@ Entrance* Map::GetEntrance(const ieVariable& Name) const
 
 bool Map::HasActor(const Actor* actor) const
 {
-	for (const Actor* act : actors) {
-		if (act == actor) {
-			return true;
-		}
-	}
-	return false;
+	return actorGrid.Contains(actor);
 }
 
 void Map::RemoveActor(Actor* actor)
@@ -2969,7 +3076,9 @@ void Map::RemoveActor(Actor* actor)
 			ClearSearchMapFor(actor);
 			actor->SetMap(nullptr);
 			actor->AreaName.Reset();
+			actorGrid.Remove(actor);
 			actors.erase(actors.begin() + i);
+			statIndex.Invalidate();
 			return;
 		}
 	}
@@ -23,11 +23,15 @@
 
 #include "exports.h"
 
+#include "ActorGrid.h"
+#include "ActorStatIndex.h"
 #include "AreaAnimation.h"
 #include "Bitmap.h"
+#include "ClearanceMap.h"
 #include "FogRenderer.h"
 #include "MapReverb.h"
 #include "PathFinder.h"
+#include "PathfinderHierarchy.h"
 #include "Polygon.h"
 #include "TableMgr.h"
 #include "TraversabilityCache.h"
@@ -58,6 +62,8 @@ class VEFObject;
 
 //distance of actors from spawn point
 #define SPAWN_RANGE 400
+// how close the party has to be to a travel region to start loading its destination
+#define PRELOAD_EXIT_RANGE 400
 
 //spawn flags
 #define SPF_NOSPAWN 0x0001 //if set don't span if WAIT is set
@@ -333,6 +339,8 @@ private:
 
 	std::list<AreaAnimation> animations;
 	std::vector<Actor*> actors;
+	ActorGrid actorGrid; // the same actors, bucketed by position
+	mutable ActorStatIndex statIndex; // and by their IDS stats
 	std::vector<WallPolygonGroup> wallGroups;
 	std::list<VEFObject*> vvcCells;
 	std::list<Projectile*> projectiles;
@@ -347,6 +355,22 @@ private:
 
 	friend class TraversabilityCache;
 	TraversabilityCache traversabilityCache;
+	PathfinderWorkspace pathfinderWorkspace;
+	PathfinderHierarchy pathfinderHierarchy;
+	ClearanceMap clearanceMap;
+	mutable std::unordered_map<uint64_t, bool> losCache; // keyed by the source and destination cell
+
+	struct PlannedPath {
+		const Actor* actor;
+		Point source;
+		Point destination;
+		unsigned int minDistance; // what FindPath was asked for, so other searches don't get it
+		int flags;
+		Path path;
+	};
+	std::vector<PlannedPath> plannedPaths;
+	tick_t plannedPathsTime = 0;
+	tick_t scriptDeadline = 0; // when the actor scripts of this tick ran out of time, 0 if unlimited
 
 	VideoBufferPtr wallStencil = nullptr;
 	Region stencilViewport;
@@ -385,6 +409,9 @@ private:
 	friend class AREImporter;
 
 public:
+	// milliseconds per tick for actor scripts, the less important ones wait for later ticks beyond it
+	static tick_t ScriptBudget;
+
 	Map(TileMap* tm, TileProps tileProps, Holder<Sprite2D> sm);
 	~Map(void) override;
 	static void NormalizeDeltas(float_t& dx, float_t& dy, float_t factor = 1);
@@ -397,8 +424,11 @@ public:
 	bool ChangeMap(bool day_or_night);
 	void SeeSpellCast(Scriptable* caster, ieDword spell) const;
 	void SetTileMapProps(TileProps props);
+	// the searchmap changed under p, so the derived pathfinding and sight data needs an update
+	void InvalidatePathfinderData(const SearchmapPoint& p);
 	void AutoLockDoors() const;
 	void UpdateScripts();
+	bool ScriptBudgetSpent() const { return scriptDeadline && GetMilliseconds() >= scriptDeadline; }
 	ResRef ResolveTerrainSound(const ResRef& sound, const Point& pos) const;
 	void DoStepForActor(Actor* actor, ieDword time) const;
 	void UpdateEffects();
@@ -446,6 +476,11 @@ public:
 	void InitActors();
 	void MarkVisited(const Actor* actor) const;
 	void AddActor(Actor* actor, bool init);
+	/* the actor moved or changed size, so the grid behind the proximity queries needs an update */
+	void UpdateActorGrid(const Actor* actor) { actorGrid.Update(actor); }
+	/* an IDS matching stat of an actor changed, so the stat index needs a rebuild */
+	void ActorStatsChanged() const { statIndex.Invalidate(); }
+	const ActorStatIndex& GetActorStatIndex() const;
 	//counts the summons already in the area
 	int CountSummons(ieDword flag, ieDword sex) const;
 	//returns true if an enemy is near P (used in resting/saving)
@@ -464,8 +499,15 @@ public:
 	// helper function used when the size > 2
 	PathMapFlags GetChildBlockedStatusForBigSize(const SearchmapPoint& smptChild, const unsigned int size) const
 	{
+		// the pathfinder only cares whether the cell can be entered, which actors on open ground don't change
+		if (clearanceMap.OnOpenGround(smptChild, size)) return PathMapFlags::PASSABLE;
 		return GetBlockedInRadiusTile(smptChild, size);
 	}
+	// like the above, but for line checks, which also need to know about actors in the way
+	PathMapFlags GetLineBlockedStatusForBigSize(const SearchmapPoint& smpt, const unsigned int size) const
+	{
+		return GetBlockedInRadiusTile(smpt, size);
+	}
 	// helper function used when the size <= 2
 	PathMapFlags GetChildBlockedStatusForSmallSize(const SearchmapPoint& smptChild, const unsigned int /* size */) const
 	{
@@ -570,6 +612,10 @@ public:
 	Path GetLinePath(const Point& start, const Point& dest, int speed, orient_t Orientation, int flags) const;
 	/* Finds the path which leads to near d */
 	Path FindPath(const Point& s, const Point& d, unsigned int size, unsigned int minDistance = 0, int flags = PF_SIGHT, const Actor* caller = nullptr);
+	/* Finds the paths of a group heading to nearby destinations with one shared search, empty where it couldn't */
+	std::vector<Path> FindGroupPaths(const std::vector<Actor*>& group, const std::vector<Point>& destinations);
+	/* Like FindGroupPaths, but keeps the paths for the FindPath calls of the members starting to walk */
+	void PlanGroupMovement(const std::vector<Actor*>& group, const std::vector<Point>& destinations);
 
 	bool IsVisible(const Point& p) const;
 	bool IsExplored(const Point& p) const;
@@ -634,6 +680,7 @@ private:
 	VEFObject* GetNextScriptedAnimation(const scaIterator& iter) const;
 	Actor* GetNextActor(int& q, size_t& index) const;
 	Container* GetNextPile(size_t& index) const;
+	Path TakePlannedPath(const Actor* caller, const Point& s, const Point& d, unsigned int minDistance, int flags);
 
 	void RedrawScreenStencil(const Region& vp, const WallPolygonGroup& walls);
 	void DrawStencil(const VideoBufferPtr& stencilBuffer, const Region& vp, const WallPolygonGroup& walls) const;
@@ -662,6 +709,8 @@ private:
 	void DeleteActor(size_t idx);
 	//actor uses travel region
 	void UseExit(Actor* pc, InfoPoint* ip);
+	void PreloadExit(const InfoPoint* ip, ieDword time) const;
+	std::vector<Actor*> GetTrapEntrants(const InfoPoint* ip, std::unordered_map<const Actor*, size_t>& runOrder) const;
 	//separated position adjustment, so their order could be randomised
 	bool AdjustPositionX(SearchmapPoint& goal, const Size& radius, int size = -1) const;
 	bool AdjustPositionY(SearchmapPoint& goal, const Size& radius, int size = -1) const;
@@ -669,6 +718,7 @@ private:
 	void UpdateSpawns() const;
 	PathMapFlags GetBlockedInLine(const NavmapPoint& s, const NavmapPoint& d, bool stopOnImpassable, const Actor* caller = nullptr) const;
 	PathMapFlags GetBlockedInLineTile(const SearchmapPoint& s, const SearchmapPoint& d, bool stopOnImpassable, const Actor* caller = nullptr) const;
+	bool IsSightBlockedInLine(const SearchmapPoint& s, const SearchmapPoint& d) const;
 	void AddProjectile(Projectile* pro);
 
 	// same as GetBlocked, but in TileCoords
@@ -45,6 +45,7 @@
 #include "Logging/Logging.h"
 #include "Scriptable/Actor.h"
 
+#include <algorithm>
 #include <array>
 #include <limits>
 
@@ -53,6 +54,12 @@ namespace GemRB {
 constexpr size_t DEGREES_OF_FREEDOM = 4;
 constexpr size_t RAND_DEGREES_OF_FREEDOM = 16;
 constexpr unsigned int SEARCHMAP_SQUARE_DIAGONAL = 20; // sqrt(16 * 16 + 12 * 12)
+// below this (manhattan) searchmap distance the plain search is cheap enough
+constexpr unsigned int HIERARCHY_MIN_DISTANCE = 2 * PathfinderHierarchy::CLUSTER_SIZE;
+// how long planned group paths wait for their actors to start walking
+constexpr tick_t PLANNED_PATH_TIMEOUT = 1000;
+// how far back along the group route members look for a shortcut to their own spot
+constexpr size_t GROUP_JOIN_RANGE = 32;
 constexpr std::array<char, DEGREES_OF_FREEDOM> dxAdjacent { { 1, 0, -1, 0 } };
 constexpr std::array<char, DEGREES_OF_FREEDOM> dyAdjacent { { 0, 1, 0, -1 } };
 
@@ -227,12 +234,18 @@ Path Map::FindPath(const Point& s, const Point& d, const unsigned int size, unsi
 	TRACY(ZoneScoped);
 
 	traversabilityCache.Update();
+	clearanceMap.Update(tileProps);
 
 	if (InDebugMode(DebugMode::PATHFINDER))
 		Log(DEBUG, "FindPath", "s = {}, d = {}, caller = {}, dist = {}, size = {}",
 		    s, d,
 		    fmt::WideToChar { caller ? caller->GetShortName() : u"nullptr" },
 		    minDistance, size);
+
+	if (caller && !plannedPaths.empty()) {
+		Path planned = TakePlannedPath(caller, s, d, minDistance, flags);
+		if (planned) return planned;
+	}
 	const bool actorsAreBlocking = flags & PF_ACTORS_ARE_BLOCKING;
 	const auto blockingTraversabilityValue = actorsAreBlocking ? TraversabilityCache::TraversabilityCellValueActor : TraversabilityCache::TraversabilityCellValueActorNonTraversable;
 
@@ -267,35 +280,21 @@ Path Map::FindPath(const Point& s, const Point& d, const unsigned int size, unsi
 	// Initialize data structures
 	const size_t mapCellsCount = mapSize.Area();
 
-	// make most data storage for this algorithm static, to avoid memory allocations;
-	// each run we just clear the storage, which is keeping the underlying allocated memory at hand
+	// the open set doesn't depend on the map size, so it's shared; it is big and only cheaply cleared
 	static BucketPriorityQueue open;
-	static std::vector<bool> isClosed;
-	static std::vector<NavmapPoint> parents;
-	static std::vector<unsigned short> distFromStart;
-
-	// resize if needed (in case of a map change; probably can be done once, when new map is loaded)
-	if (isClosed.size() != mapCellsCount) {
-		parents.resize(mapCellsCount);
-		distFromStart.resize(mapCellsCount);
+	PathfinderWorkspace& nodes = pathfinderWorkspace;
+
+	// long journeys are first routed over the coarse map and then only refined along that corridor
+	bool useCorridor = false;
+	if (unsigned(std::abs(smptDest.x - smptSource.x) + std::abs(smptDest.y - smptSource.y)) >= HIERARCHY_MIN_DISTANCE) {
+		auto route = pathfinderHierarchy.FindCorridor(tileProps, smptSource, smptDest);
+		// terrain and doors alone keep us apart, so don't bother flooding the whole map
+		if (route == PathfinderHierarchy::Route::UNREACHABLE && !minDistance) {
+			return {};
+		}
+		useCorridor = route == PathfinderHierarchy::Route::FOUND;
 	}
 
-	// cleanup
-	open.Clear();
-	isClosed.clear();
-	isClosed.resize(mapCellsCount, false);
-	// `.clear() + .resize()` is generally more performant than `memset` in cases where we have relatively small
-	// number of elements, while memset performs better for large vectors
-	memset(static_cast<void*>(parents.data()), 0, sizeof(decltype(parents)::value_type) * mapCellsCount);
-	memset(static_cast<void*>(distFromStart.data()), 255, sizeof(decltype(distFromStart)::value_type) * mapCellsCount);
-
-	// begin algo init
-	distFromStart[smptSource.y * mapSize.w + smptSource.x] = 0;
-	parents[smptSource.y * mapSize.w + smptSource.x] = nmptSource;
-
-	open.Push(nmptSource, 0);
-
-	bool foundPath = false;
 	unsigned int squaredMinDist = minDistance * minDistance;
 
 	// Weighted heuristic. Finds sub-optimal paths but should be quite a bit faster
@@ -310,97 +309,115 @@ Path Map::FindPath(const Point& s, const Point& d, const unsigned int size, unsi
 		const int crossProduct = std::abs(xDist * dyCross - yDist * dxCross) >> 3;
 		const float distance = std::hypotf(xDist, yDist);
 		const float heuristic = HEURISTIC_WEIGHT * (distance + crossProduct);
-		const float estDist = distFromStart[smptChildIdx] + heuristic;
+		const float estDist = nodes[smptChildIdx].distFromStart + heuristic;
 		return estDist;
 	};
 
-	while (!open.IsEmpty()) {
-		const NavmapPoint nmptCurrent = open.Pop();
+	bool foundPath = false;
+	// if actors or the caller's size block the corridor, retry without it
+	for (bool restricted = useCorridor; !foundPath; restricted = false) {
+		open.Clear();
+		nodes.Reset(mapCellsCount);
 
-		const SearchmapPoint smptCurrent { nmptCurrent };
-		const int smptCurrentIdx = smptCurrent.y * mapSize.w + smptCurrent.x;
-		if (parents[smptCurrentIdx].IsZero()) {
-			continue;
-		}
+		// begin algo init
+		nodes[smptSource.y * mapSize.w + smptSource.x].distFromStart = 0;
+		nodes[smptSource.y * mapSize.w + smptSource.x].parent = nmptSource;
 
-		if (smptCurrent == smptDest) {
-			nmptDest = nmptCurrent;
-			foundPath = true;
-			break;
-		}
+		open.Push(nmptSource, 0);
 
-		if (minDistance &&
-		    parents[smptCurrentIdx] != nmptCurrent &&
-		    SquaredDistance(nmptCurrent, nmptDest) < squaredMinDist &&
-		    (!(flags & PF_SIGHT) || IsVisibleLOS(smptCurrent, smptDest0, caller))) { // FIXME: should probably be smptDest
-			smptDest = smptCurrent;
-			nmptDest = nmptCurrent;
-			foundPath = true;
-			break;
-		}
+		while (!open.IsEmpty()) {
+			const NavmapPoint nmptCurrent = open.Pop();
 
-		isClosed[smptCurrentIdx] = true;
+			const SearchmapPoint smptCurrent { nmptCurrent };
+			const int smptCurrentIdx = smptCurrent.y * mapSize.w + smptCurrent.x;
+			if (nodes[smptCurrentIdx].parent.IsZero()) {
+				continue;
+			}
 
-		for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
-			const NavmapPoint nmptChild(nmptCurrent.x + 16 * dxAdjacent[i], nmptCurrent.y + 12 * dyAdjacent[i]);
-			const SearchmapPoint smptChild { nmptChild };
-			// Outside map
-			if (smptChild.x < 0 || smptChild.y < 0 || smptChild.x >= mapSize.w || smptChild.y >= mapSize.h) continue;
-			// Already visited
-			int smptChildIdx = smptChild.y * mapSize.w + smptChild.x;
-			if (isClosed[smptChildIdx]) continue;
-
-			const PathMapFlags childBlockStatus = (this->*getChildBlockedStatusFn)(smptChild, size);
-			bool childBlocked = !(childBlockStatus & (PathMapFlags::PASSABLE | PathMapFlags::ACTOR));
-			if (childBlocked) continue;
-
-			// If there's an actor, check it can be bumped away
-			const auto navmapCellTraversability = traversabilityCache.GetCellData(nmptChild.y * mapSize.w * 16 + nmptChild.x);
-			const bool childIsUnbumpable = navmapCellTraversability.occupyingActor != caller && navmapCellTraversability.state >= blockingTraversabilityValue;
-			if (childIsUnbumpable) continue;
-
-			SearchmapPoint smptCurrent2 { nmptCurrent };
-			NavmapPoint nmptParent = parents[smptCurrent2.y * mapSize.w + smptCurrent2.x];
-			SearchmapPoint smptParent { nmptParent };
-			unsigned short oldDist = distFromStart[smptChildIdx];
-
-			// Lazy Theta star*
-			unsigned short newDist = distFromStart[smptParent.y * mapSize.w + smptParent.x] + Distance(smptParent, smptChild);
-			if (newDist < oldDist) {
-				parents[smptChildIdx] = nmptParent;
-				distFromStart[smptChildIdx] = newDist;
+			if (smptCurrent == smptDest) {
+				nmptDest = nmptCurrent;
+				foundPath = true;
+				break;
 			}
 
-			if (distFromStart[smptChildIdx] < oldDist) {
-				// Theta-star path if there is LOS
-				// so far the searchmap grid appears too coarse to play on, see #2261
-				//if (!IsWalkableTo(smptParent, smptChild, actorsAreBlocking, caller)) {
-				if (!IsWalkableTo(nmptParent, nmptChild, actorsAreBlocking, caller)) {
-					// Fall back to A-star path
-					distFromStart[smptChildIdx] = std::numeric_limits<unsigned short>::max();
-					// Find already visited neighbour with shortest: path from start + path to child
-					for (size_t j = 0; j < DEGREES_OF_FREEDOM; j++) {
-						NavmapPoint nmptVis(nmptChild.x + 16 * dxAdjacent[j], nmptChild.y + 12 * dyAdjacent[j]);
-						SearchmapPoint smptVis { nmptVis };
-						// Outside map
-						if (smptVis.x < 0 || smptVis.y < 0 || smptVis.x >= mapSize.w || smptVis.y >= mapSize.h) continue;
-						// Only consider already visited
-						if (!isClosed[smptVis.y * mapSize.w + smptVis.x]) continue;
-
-						unsigned short oldVisDist = distFromStart[smptChildIdx];
-						newDist = distFromStart[smptVis.y * mapSize.w + smptVis.x] + Distance(smptVis, smptChild);
-						if (newDist < oldVisDist) {
-							parents[smptChildIdx] = nmptVis;
-							distFromStart[smptChildIdx] = newDist;
+			if (minDistance &&
+			    nodes[smptCurrentIdx].parent != nmptCurrent &&
+			    SquaredDistance(nmptCurrent, nmptDest) < squaredMinDist &&
+			    (!(flags & PF_SIGHT) || IsVisibleLOS(smptCurrent, smptDest0, caller))) { // FIXME: should probably be smptDest
+				smptDest = smptCurrent;
+				nmptDest = nmptCurrent;
+				foundPath = true;
+				break;
+			}
+
+			nodes[smptCurrentIdx].isClosed = true;
+
+			for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
+				const NavmapPoint nmptChild(nmptCurrent.x + 16 * dxAdjacent[i], nmptCurrent.y + 12 * dyAdjacent[i]);
+				const SearchmapPoint smptChild { nmptChild };
+				// Outside map
+				if (smptChild.x < 0 || smptChild.y < 0 || smptChild.x >= mapSize.w || smptChild.y >= mapSize.h) continue;
+				if (restricted && !pathfinderHierarchy.InCorridor(smptChild)) continue;
+				// Already visited
+				int smptChildIdx = smptChild.y * mapSize.w + smptChild.x;
+				PathfinderWorkspace::Cell& child = nodes[smptChildIdx];
+				if (child.isClosed) continue;
+
+				const PathMapFlags childBlockStatus = (this->*getChildBlockedStatusFn)(smptChild, size);
+				bool childBlocked = !(childBlockStatus & (PathMapFlags::PASSABLE | PathMapFlags::ACTOR));
+				if (childBlocked) continue;
+
+				// If there's an actor, check it can be bumped away
+				const auto navmapCellTraversability = traversabilityCache.GetCellData(nmptChild.y * mapSize.w * 16 + nmptChild.x);
+				const bool childIsUnbumpable = navmapCellTraversability.occupyingActor != caller && navmapCellTraversability.state >= blockingTraversabilityValue;
+				if (childIsUnbumpable) continue;
+
+				SearchmapPoint smptCurrent2 { nmptCurrent };
+				NavmapPoint nmptParent = nodes[smptCurrent2.y * mapSize.w + smptCurrent2.x].parent;
+				SearchmapPoint smptParent { nmptParent };
+				unsigned short oldDist = child.distFromStart;
+
+				// Lazy Theta star*
+				unsigned short newDist = nodes[smptParent.y * mapSize.w + smptParent.x].distFromStart + Distance(smptParent, smptChild);
+				if (newDist < oldDist) {
+					child.parent = nmptParent;
+					child.distFromStart = newDist;
+				}
+
+				if (child.distFromStart < oldDist) {
+					// Theta-star path if there is LOS
+					// so far the searchmap grid appears too coarse to play on, see #2261
+					//if (!IsWalkableTo(smptParent, smptChild, actorsAreBlocking, caller)) {
+					if (!IsWalkableTo(nmptParent, nmptChild, actorsAreBlocking, caller)) {
+						// Fall back to A-star path
+						child.distFromStart = std::numeric_limits<unsigned short>::max();
+						// Find already visited neighbour with shortest: path from start + path to child
+						for (size_t j = 0; j < DEGREES_OF_FREEDOM; j++) {
+							NavmapPoint nmptVis(nmptChild.x + 16 * dxAdjacent[j], nmptChild.y + 12 * dyAdjacent[j]);
+							SearchmapPoint smptVis { nmptVis };
+							// Outside map
+							if (smptVis.x < 0 || smptVis.y < 0 || smptVis.x >= mapSize.w || smptVis.y >= mapSize.h) continue;
+							// Only consider already visited
+							const PathfinderWorkspace::Cell& visited = nodes[smptVis.y * mapSize.w + smptVis.x];
+							if (!visited.isClosed) continue;
+
+							unsigned short oldVisDist = child.distFromStart;
+							newDist = visited.distFromStart + Distance(smptVis, smptChild);
+							if (newDist < oldVisDist) {
+								child.parent = nmptVis;
+								child.distFromStart = newDist;
+							}
 						}
+						if (child.distFromStart >= oldDist) continue;
 					}
-					if (distFromStart[smptChildIdx] >= oldDist) continue;
-				}
 
-				const float newCost = getHeuristic(smptChild, smptChildIdx);
-				open.Push(nmptChild, newCost);
+					const float newCost = getHeuristic(smptChild, smptChildIdx);
+					open.Push(nmptChild, newCost);
+				}
 			}
 		}
+
+		if (!restricted) break;
 	}
 
 	if (foundPath) {
@@ -408,8 +425,8 @@ Path Map::FindPath(const Point& s, const Point& d, const unsigned int size, unsi
 		NavmapPoint nmptCurrent = nmptDest;
 		NavmapPoint nmptParent;
 		SearchmapPoint smptCurrent { nmptCurrent };
-		while (!resultPath || nmptCurrent != parents[smptCurrent.y * mapSize.w + smptCurrent.x]) {
-			nmptParent = parents[smptCurrent.y * mapSize.w + smptCurrent.x];
+		while (!resultPath || nmptCurrent != nodes[smptCurrent.y * mapSize.w + smptCurrent.x].parent) {
+			nmptParent = nodes[smptCurrent.y * mapSize.w + smptCurrent.x].parent;
 			PathNode newStep { nmptCurrent, S };
 			// movement in general allows characters to walk backwards given that
 			// the destination is behind the character (within a threshold), and
@@ -439,6 +456,193 @@ Path Map::FindPath(const Point& s, const Point& d, const unsigned int size, unsi
 	return {};
 }
 
+Path Map::TakePlannedPath(const Actor* caller, const Point& s, const Point& d, unsigned int minDistance, int flags)
+{
+	// the group was given new orders or got stuck, so the plan is stale
+	if (GetMilliseconds() > plannedPathsTime + PLANNED_PATH_TIMEOUT) {
+		plannedPaths.clear();
+		return {};
+	}
+
+	auto planned = std::find_if(plannedPaths.begin(), plannedPaths.end(), [&](const PlannedPath& plan) {
+		return plan.actor == caller && plan.source == s && plan.destination == d &&
+		       plan.minDistance == minDistance && plan.flags == flags;
+	});
+	if (planned == plannedPaths.end()) return {};
+
+	Path path = std::move(planned->path);
+	plannedPaths.erase(planned);
+	return path;
+}
+
+void Map::PlanGroupMovement(const std::vector<Actor*>& group, const std::vector<Point>& destinations)
+{
+	plannedPaths.clear();
+	std::vector<Path> paths = FindGroupPaths(group, destinations);
+	// they stand in for the first search of a plain walk, eg. not for reaching travel regions
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (!paths[i]) continue;
+		plannedPaths.push_back({ group[i], group[i]->Pos, destinations[i], 0, PF_SIGHT | PF_ACTORS_ARE_BLOCKING, std::move(paths[i]) });
+	}
+	plannedPathsTime = GetMilliseconds();
+}
+
+// Instead of a search per member, a single reverse breadth-first search floods out from
+// where the group is heading, until it reaches every member. Each one then descends that
+// distance field, leaves it as soon as its own spot is walkable, and the resulting cell
+// chain is pulled taut into a few waypoints. Like the first FindPath pass, actors outside
+// the group block, while the members themselves don't, since they're all leaving.
+std::vector<Path> Map::FindGroupPaths(const std::vector<Actor*>& group, const std::vector<Point>& destinations)
+{
+	TRACY(ZoneScoped);
+
+	std::vector<Path> paths(group.size());
+	if (group.size() < 2 || group.size() != destinations.size()) return paths;
+
+	traversabilityCache.Update();
+	const Size& mapSize = PropsSize();
+
+	// big creatures need the clearance checks of the regular search
+	std::vector<SearchmapPoint> starts(group.size());
+	std::vector<bool> planned(group.size(), false);
+	Point centroid;
+	int count = 0;
+	for (size_t i = 0; i < group.size(); ++i) {
+		const Actor* actor = group[i];
+		starts[i] = SearchmapPoint(actor->Pos);
+		if (actor->GetCurrentArea() != this || actor->circleSize > 2) continue;
+		if (!mapSize.PointInside(starts[i]) || starts[i] == SearchmapPoint(destinations[i])) continue;
+		if (!(GetBlockedInRadiusTile(SearchmapPoint(destinations[i]), actor->circleSize) & PathMapFlags::PASSABLE)) continue;
+
+		planned[i] = true;
+		centroid += destinations[i];
+		++count;
+	}
+	if (count < 2) return paths;
+
+	auto isMember = [&group](const Actor* actor) {
+		return std::find(group.begin(), group.end(), actor) != group.end();
+	};
+	auto isOpen = [&](const SearchmapPoint& p) {
+		if (!PathfinderHierarchy::IsPassable(tileProps, p)) return false;
+		const auto traversability = traversabilityCache.GetCellData(p.y * 12 * mapSize.w * 16 + p.x * 16);
+		return traversability.state < TraversabilityCache::TraversabilityCellValueActor || isMember(traversability.occupyingActor);
+	};
+
+	const size_t leader = std::find(planned.begin(), planned.end(), true) - planned.begin();
+	SearchmapPoint origin { Point(centroid.x / count, centroid.y / count) };
+	if (!mapSize.PointInside(origin) || !isOpen(origin)) {
+		// the formation wraps around an obstacle, so use a spot we know is fine
+		origin = SearchmapPoint(destinations[leader]);
+	}
+
+	bool restricted = false;
+	if (unsigned(std::abs(starts[leader].x - origin.x) + std::abs(starts[leader].y - origin.y)) >= HIERARCHY_MIN_DISTANCE) {
+		auto route = pathfinderHierarchy.FindCorridor(tileProps, starts[leader], origin);
+		if (route == PathfinderHierarchy::Route::UNREACHABLE) return paths;
+		restricted = route == PathfinderHierarchy::Route::FOUND;
+	}
+
+	// distFromStart is the distance to the origin here, in steps
+	PathfinderWorkspace& nodes = pathfinderWorkspace;
+	nodes.Reset(mapSize.Area());
+	std::vector<SearchmapPoint> queue;
+	queue.push_back(origin);
+	nodes[origin.y * mapSize.w + origin.x].distFromStart = 0;
+	nodes[origin.y * mapSize.w + origin.x].isClosed = true;
+
+	int unreached = count;
+	for (size_t head = 0; head < queue.size() && unreached; ++head) {
+		const SearchmapPoint current = queue[head];
+		const unsigned short dist = nodes[current.y * mapSize.w + current.x].distFromStart;
+		for (size_t i = 0; i < group.size(); ++i) {
+			if (planned[i] && starts[i] == current) --unreached;
+		}
+
+		for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
+			const SearchmapPoint next(current.x + dxAdjacent[i], current.y + dyAdjacent[i]);
+			if (!mapSize.PointInside(next)) continue;
+			if (restricted && !pathfinderHierarchy.InCorridor(next)) continue;
+			PathfinderWorkspace::Cell& cell = nodes[next.y * mapSize.w + next.x];
+			if (cell.isClosed) continue;
+
+			cell.isClosed = true;
+			// members may stand on cells that are otherwise blocked, let them out
+			bool isStart = std::find(starts.begin(), starts.end(), next) != starts.end();
+			if (!isStart && !isOpen(next)) continue;
+
+			cell.distFromStart = dist + 1;
+			queue.push_back(next);
+		}
+	}
+
+	// the members shouldn't get in the way of each other's shortcuts
+	for (const Actor* actor : group) {
+		if (actor->GetCurrentArea() == this && actor->BlocksSearchMap()) ClearSearchMapFor(actor);
+	}
+
+	auto cellCenter = [](const SearchmapPoint& p) {
+		return NavmapPoint(p.x * 16 + 8, p.y * 12 + 6);
+	};
+
+	for (size_t m = 0; m < group.size(); ++m) {
+		if (!planned[m]) continue;
+		const Actor* actor = group[m];
+		const Point& dest = destinations[m];
+
+		// walk down the distance field
+		SearchmapPoint current = starts[m];
+		unsigned short dist = nodes[current.y * mapSize.w + current.x].distFromStart;
+		if (dist == UINT16_MAX) continue;
+
+		std::vector<SearchmapPoint> chain;
+		while (dist > 0) {
+			for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
+				const SearchmapPoint next(current.x + dxAdjacent[i], current.y + dyAdjacent[i]);
+				if (!mapSize.PointInside(next)) continue;
+				if (nodes[next.y * mapSize.w + next.x].distFromStart == dist - 1) {
+					current = next;
+					break;
+				}
+			}
+			--dist;
+			chain.push_back(current);
+		}
+
+		// leave as early as our own spot comes in reach
+		size_t leave = chain.size();
+		size_t limit = chain.size() > GROUP_JOIN_RANGE ? chain.size() - GROUP_JOIN_RANGE : 0;
+		while (leave > limit && IsWalkableTo(cellCenter(chain[leave - 1]), dest, true, actor)) {
+			--leave;
+		}
+		if (chain.empty() ? !IsWalkableTo(actor->Pos, dest, true, actor) : leave == chain.size()) continue;
+
+		std::vector<NavmapPoint> points;
+		points.push_back(actor->Pos);
+		for (size_t i = 0; i < std::min(leave + 1, chain.size()); ++i) {
+			points.push_back(cellCenter(chain[i]));
+		}
+		points.push_back(dest);
+
+		// string pulling
+		Path path;
+		size_t anchor = 0;
+		for (size_t i = 2; i < points.size(); ++i) {
+			if (IsWalkableTo(points[anchor], points[i], true, actor)) continue;
+			path.AppendStep({ points[i - 1], GetOrient(points[anchor], points[i - 1]) });
+			anchor = i - 1;
+		}
+		path.AppendStep({ dest, GetOrient(points[anchor], dest) });
+		paths[m] = std::move(path);
+	}
+
+	for (const Actor* actor : group) {
+		if (actor->GetCurrentArea() == this && actor->BlocksSearchMap()) BlockSearchMapFor(actor);
+	}
+
+	return paths;
+}
+
 void Map::NormalizeDeltas(float_t& dx, float_t& dy, const float_t factor)
 {
 	constexpr float_t STEP_RADIUS = 2.0;
@@ -143,6 +143,47 @@ struct Path {
 };
 static_assert(std::is_nothrow_move_constructible<Path>::value, "Path should be noexcept MoveConstructible");
 
+/**
+ * Per-searchmap-cell state of Map::FindPath, owned by the Map and reused between queries.
+ * Instead of clearing everything for each query, cells carry the generation they were last
+ * touched in and are reset lazily on first access, so a query only pays for the cells it visits.
+ */
+class PathfinderWorkspace {
+public:
+	struct Cell {
+		NavmapPoint parent;
+		uint32_t generation = 0;
+		unsigned short distFromStart = 0;
+		bool isClosed = false;
+	};
+
+	// starts a new query, only clearing the storage if the size changed or the generation wrapped
+	void Reset(size_t cellsCount)
+	{
+		if (cells.size() != cellsCount || generation == UINT32_MAX) {
+			cells.assign(cellsCount, Cell());
+			generation = 0;
+		}
+		++generation;
+	}
+
+	Cell& operator[](size_t idx)
+	{
+		Cell& cell = cells[idx];
+		if (cell.generation != generation) {
+			cell.parent = NavmapPoint();
+			cell.generation = generation;
+			cell.distFromStart = UINT16_MAX;
+			cell.isClosed = false;
+		}
+		return cell;
+	}
+
+private:
+	std::vector<Cell> cells;
+	uint32_t generation = 0;
+};
+
 enum {
 	PF_SIGHT = 1,
 	PF_BACKAWAY = 2,
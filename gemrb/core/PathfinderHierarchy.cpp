@@ -0,0 +1,284 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "PathfinderHierarchy.h"
+
+#include "Map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+namespace GemRB {
+
+static constexpr uint32_t INVALID_REGION = UINT32_MAX;
+
+// Map::GetBlockedTile, but ignoring actors, since they move all the time
+bool PathfinderHierarchy::IsPassable(const TileProps& props, const SearchmapPoint& p)
+{
+	PathMapFlags flags = props.QuerySearchMap(p) & PathMapFlags::NOTACTOR;
+	if (bool(flags & (PathMapFlags::DOOR_IMPASSABLE | PathMapFlags::DOOR_OPAQUE))) {
+		return false;
+	}
+	return bool(flags & (PathMapFlags::PASSABLE | PathMapFlags::TRAVEL));
+}
+
+void PathfinderHierarchy::Build(const TileProps& props)
+{
+	mapSize = props.GetSize();
+	clustersWide = (mapSize.w + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	clustersHigh = (mapSize.h + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	size_t clusterCount = clustersWide * clustersHigh;
+
+	regionOf.assign(mapSize.Area(), NO_REGION);
+	clusters.assign(clusterCount, Cluster());
+	dirtyClusters.resize(clusterCount);
+	for (size_t i = 0; i < clusterCount; ++i) {
+		dirtyClusters[i] = int(i);
+	}
+	corridor.assign(clusterCount, 0);
+	corridorGeneration = 0;
+
+	Update(props);
+}
+
+void PathfinderHierarchy::Invalidate(const SearchmapPoint& p)
+{
+	if (!mapSize.PointInside(p)) return;
+
+	int cluster = (p.y / CLUSTER_SIZE) * clustersWide + p.x / CLUSTER_SIZE;
+	if (!clusters[cluster].dirty) {
+		clusters[cluster].dirty = true;
+		dirtyClusters.push_back(cluster);
+	}
+}
+
+void PathfinderHierarchy::Update(const TileProps& props)
+{
+	if (dirtyClusters.empty()) return;
+
+	for (int cluster : dirtyClusters) {
+		BuildRegions(props, cluster);
+	}
+
+	// the portals of the neighbours point into the rebuilt regions, so relink them too
+	std::vector<int> relink;
+	for (int cluster : dirtyClusters) {
+		int cx = cluster % clustersWide;
+		int cy = cluster / clustersWide;
+		relink.push_back(cluster);
+		if (cx > 0) relink.push_back(cluster - 1);
+		if (cx < clustersWide - 1) relink.push_back(cluster + 1);
+		if (cy > 0) relink.push_back(cluster - clustersWide);
+		if (cy < clustersHigh - 1) relink.push_back(cluster + clustersWide);
+	}
+	std::sort(relink.begin(), relink.end());
+	relink.erase(std::unique(relink.begin(), relink.end()), relink.end());
+	for (int cluster : relink) {
+		LinkRegions(cluster);
+	}
+
+	for (int cluster : dirtyClusters) {
+		clusters[cluster].dirty = false;
+	}
+	dirtyClusters.clear();
+}
+
+void PathfinderHierarchy::BuildRegions(const TileProps& props, int cluster)
+{
+	int x0 = (cluster % clustersWide) * CLUSTER_SIZE;
+	int y0 = (cluster / clustersWide) * CLUSTER_SIZE;
+	int x1 = std::min(x0 + CLUSTER_SIZE, mapSize.w);
+	int y1 = std::min(y0 + CLUSTER_SIZE, mapSize.h);
+
+	auto& regions = clusters[cluster].regions;
+	regions.clear();
+	for (int y = y0; y < y1; ++y) {
+		std::fill_n(&regionOf[y * mapSize.w + x0], x1 - x0, NO_REGION);
+	}
+
+	// flood fill the 4-connected passable areas
+	std::vector<SearchmapPoint> stack;
+	for (int y = y0; y < y1; ++y) {
+		for (int x = x0; x < x1; ++x) {
+			SearchmapPoint seed(x, y);
+			if (regionOf[y * mapSize.w + x] != NO_REGION || !IsPassable(props, seed)) continue;
+
+			uint8_t region = uint8_t(regions.size());
+			long sumX = 0;
+			long sumY = 0;
+			long count = 0;
+			regionOf[y * mapSize.w + x] = region;
+			stack.push_back(seed);
+			while (!stack.empty()) {
+				SearchmapPoint p = stack.back();
+				stack.pop_back();
+				sumX += p.x;
+				sumY += p.y;
+				++count;
+
+				const SearchmapPoint next[] = { { p.x + 1, p.y }, { p.x - 1, p.y }, { p.x, p.y + 1 }, { p.x, p.y - 1 } };
+				for (const auto& n : next) {
+					if (n.x < x0 || n.x >= x1 || n.y < y0 || n.y >= y1) continue;
+					uint8_t& mark = regionOf[n.y * mapSize.w + n.x];
+					if (mark != NO_REGION || !IsPassable(props, n)) continue;
+					mark = region;
+					stack.push_back(n);
+				}
+			}
+
+			Component component;
+			component.center = Point(int(sumX / count), int(sumY / count));
+			regions.push_back(std::move(component));
+		}
+	}
+}
+
+void PathfinderHierarchy::LinkRegions(int cluster)
+{
+	for (auto& region : clusters[cluster].regions) {
+		region.neighbours.clear();
+	}
+
+	int x0 = (cluster % clustersWide) * CLUSTER_SIZE;
+	int y0 = (cluster / clustersWide) * CLUSTER_SIZE;
+	int x1 = std::min(x0 + CLUSTER_SIZE, mapSize.w) - 1;
+	int y1 = std::min(y0 + CLUSTER_SIZE, mapSize.h) - 1;
+
+	for (int y = y0; y <= y1; ++y) {
+		if (x0 > 0) Link(SearchmapPoint(x0, y), SearchmapPoint(x0 - 1, y));
+		if (x1 < mapSize.w - 1) Link(SearchmapPoint(x1, y), SearchmapPoint(x1 + 1, y));
+	}
+	for (int x = x0; x <= x1; ++x) {
+		if (y0 > 0) Link(SearchmapPoint(x, y0), SearchmapPoint(x, y0 - 1));
+		if (y1 < mapSize.h - 1) Link(SearchmapPoint(x, y1), SearchmapPoint(x, y1 + 1));
+	}
+}
+
+void PathfinderHierarchy::Link(const SearchmapPoint& from, const SearchmapPoint& to)
+{
+	RegionID a = RegionAt(from);
+	RegionID b = RegionAt(to);
+	if (a == INVALID_REGION || b == INVALID_REGION) return;
+
+	auto& neighbours = clusters[ClusterOf(a)].regions[IndexOf(a)].neighbours;
+	if (std::find(neighbours.begin(), neighbours.end(), b) == neighbours.end()) {
+		neighbours.push_back(b);
+	}
+}
+
+PathfinderHierarchy::RegionID PathfinderHierarchy::RegionAt(const SearchmapPoint& p) const
+{
+	uint8_t region = regionOf[p.y * mapSize.w + p.x];
+	if (region == NO_REGION) return INVALID_REGION;
+
+	return MakeID((p.y / CLUSTER_SIZE) * clustersWide + p.x / CLUSTER_SIZE, region);
+}
+
+// plain A* over the region graph, which is tiny compared to the searchmap
+bool PathfinderHierarchy::FindRoute(RegionID start, RegionID goal, std::vector<RegionID>& route) const
+{
+	auto centerOf = [this](RegionID id) {
+		return clusters[ClusterOf(id)].regions[IndexOf(id)].center;
+	};
+	auto cost = [](const Point& a, const Point& b) {
+		return unsigned(std::lround(std::hypot(a.x - b.x, a.y - b.y)));
+	};
+
+	const Point goalCenter = centerOf(goal);
+	using Entry = std::pair<unsigned, RegionID>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+	std::unordered_map<RegionID, unsigned> distFromStart;
+	std::unordered_map<RegionID, RegionID> parents;
+
+	distFromStart[start] = 0;
+	parents[start] = start;
+	open.emplace(cost(centerOf(start), goalCenter), start);
+	while (!open.empty()) {
+		RegionID current = open.top().second;
+		unsigned estimate = open.top().first;
+		open.pop();
+		if (current == goal) break;
+
+		const Point center = centerOf(current);
+		unsigned dist = distFromStart[current];
+		// stale entry, it was reached cheaper since
+		if (estimate > dist + cost(center, goalCenter)) continue;
+
+		for (RegionID next : clusters[ClusterOf(current)].regions[IndexOf(current)].neighbours) {
+			const Point nextCenter = centerOf(next);
+			unsigned newDist = dist + cost(center, nextCenter);
+			auto known = distFromStart.find(next);
+			if (known != distFromStart.end() && known->second <= newDist) continue;
+
+			distFromStart[next] = newDist;
+			parents[next] = current;
+			open.emplace(newDist + cost(nextCenter, goalCenter), next);
+		}
+	}
+
+	if (parents.find(goal) == parents.end()) return false;
+
+	route.clear();
+	for (RegionID id = goal; id != start; id = parents[id]) {
+		route.push_back(id);
+	}
+	route.push_back(start);
+	return true;
+}
+
+PathfinderHierarchy::Route PathfinderHierarchy::FindCorridor(const TileProps& props, const SearchmapPoint& start, const SearchmapPoint& goal)
+{
+	Update(props);
+
+	if (!mapSize.PointInside(start) || !mapSize.PointInside(goal)) {
+		return Route::UNKNOWN;
+	}
+	RegionID startRegion = RegionAt(start);
+	RegionID goalRegion = RegionAt(goal);
+	if (startRegion == INVALID_REGION || goalRegion == INVALID_REGION) {
+		return Route::UNKNOWN;
+	}
+
+	std::vector<RegionID> route;
+	if (!FindRoute(startRegion, goalRegion, route)) {
+		return Route::UNREACHABLE;
+	}
+
+	if (++corridorGeneration == 0) {
+		std::fill(corridor.begin(), corridor.end(), 0);
+		corridorGeneration = 1;
+	}
+
+	// the neighbouring clusters give the fine search some room to smooth the path and avoid actors
+	for (RegionID id : route) {
+		int cx = ClusterOf(id) % clustersWide;
+		int cy = ClusterOf(id) / clustersWide;
+		for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, clustersHigh - 1); ++y) {
+			for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, clustersWide - 1); ++x) {
+				corridor[y * clustersWide + x] = corridorGeneration;
+			}
+		}
+	}
+	return Route::FOUND;
+}
+
+}
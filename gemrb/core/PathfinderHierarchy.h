@@ -0,0 +1,102 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2025 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef PATHFINDERHIERARCHY_H
+#define PATHFINDERHIERARCHY_H
+
+#include "PathFinder.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace GemRB {
+
+class TileProps;
+
+/**
+ * Coarse view of the searchmap for long-distance queries (HPA*).
+ * The map is cut into square clusters and each cluster into its 4-connected regions of
+ * passable cells. Regions touching across a cluster border are linked through that portal.
+ * Actors are ignored, doors are not: door changes just mark their clusters for a rebuild.
+ *
+ * Map::FindPath first routes over the regions and then runs the regular search only
+ * within the clusters along that route, instead of flooding the whole map.
+ */
+class PathfinderHierarchy {
+public:
+	static constexpr int CLUSTER_SIZE = 16;
+
+	enum class Route : uint8_t {
+		FOUND, // the corridor is set up
+		UNREACHABLE, // the terrain and doors keep the points apart
+		UNKNOWN // an endpoint is not passable terrain, so no opinion
+	};
+
+	void Build(const TileProps& props);
+	/** marks the cluster of the changed cell for a rebuild before the next query */
+	void Invalidate(const SearchmapPoint& p);
+
+	/** finds a route over the regions and marks the clusters along it (and their neighbours) */
+	Route FindCorridor(const TileProps& props, const SearchmapPoint& start, const SearchmapPoint& goal);
+	bool InCorridor(const SearchmapPoint& p) const
+	{
+		return corridor[(p.y / CLUSTER_SIZE) * clustersWide + p.x / CLUSTER_SIZE] == corridorGeneration;
+	}
+	static bool IsPassable(const TileProps& props, const SearchmapPoint& p);
+
+private:
+	static constexpr uint8_t NO_REGION = 0xff;
+
+	// regions are referenced by their cluster index and the index within
+	using RegionID = uint32_t;
+	static RegionID MakeID(int cluster, uint8_t region) { return RegionID(cluster) << 8 | region; }
+	static int ClusterOf(RegionID id) { return int(id >> 8); }
+	static uint8_t IndexOf(RegionID id) { return uint8_t(id & 0xff); }
+
+	struct Component {
+		Point center; // in searchmap coordinates
+		std::vector<RegionID> neighbours;
+	};
+
+	struct Cluster {
+		std::vector<Component> regions;
+		bool dirty = true;
+	};
+
+	Size mapSize;
+	int clustersWide = 0;
+	int clustersHigh = 0;
+	std::vector<uint8_t> regionOf; // per cell
+	std::vector<Cluster> clusters;
+	std::vector<int> dirtyClusters;
+	std::vector<uint32_t> corridor; // per cluster, the generation it was last marked in
+	uint32_t corridorGeneration = 0;
+
+	void Update(const TileProps& props);
+	void BuildRegions(const TileProps& props, int cluster);
+	void LinkRegions(int cluster);
+	void Link(const SearchmapPoint& from, const SearchmapPoint& to);
+	RegionID RegionAt(const SearchmapPoint& p) const;
+	bool FindRoute(RegionID start, RegionID goal, std::vector<RegionID>& route) const;
+};
+
+}
+
+#endif
@@ -93,17 +93,107 @@ bool ResourceManager::AddSource(const path_t& path, const std::string& descripti
 		return false;
 	}
 
+	AddSource(std::move(source), flags);
+	return true;
+}
+
+void ResourceManager::AddSource(PluginHolder<ResourceSource> source, int flags)
+{
+	std::lock_guard<std::mutex> lock(searchPathMutex);
+	// a fresh copy also starts without memoized lookups
+	auto newPath = std::make_shared<SearchPath>();
+	newPath->sources = searchPath->sources;
+	newPath->volatileSources = searchPath->volatileSources;
+
+	bool isVolatile = flags & RM_VOLATILE_SOURCE;
 	if (flags & RM_REPLACE_SAME_SOURCE) {
-		for (auto& path2 : searchPath) {
-			if (description == path2->GetDescription()) {
-				path2 = std::move(source);
+		for (size_t i = 0; i < newPath->sources.size(); ++i) {
+			if (source->GetDescription() == newPath->sources[i]->GetDescription()) {
+				newPath->sources[i] = std::move(source);
+				newPath->volatileSources[i] = isVolatile;
 				break;
 			}
 		}
 	} else {
-		searchPath.push_back(std::move(source));
+		newPath->sources.push_back(std::move(source));
+		newPath->volatileSources.push_back(isVolatile);
 	}
-	return true;
+	searchPath = std::move(newPath);
+}
+
+std::shared_ptr<const ResourceManager::SearchPath> ResourceManager::GetSearchPath() const
+{
+	std::lock_guard<std::mutex> lock(searchPathMutex);
+	return searchPath;
+}
+
+ResourceManager::LookupKey ResourceManager::MakeLookupKey(StringView resRef, SClass_ID type)
+{
+	LookupKey key { std::string(resRef.c_str(), resRef.length()), type };
+	StringToLower(key.name);
+	return key;
+}
+
+ResourceManager::LookupKey ResourceManager::MakeLookupKey(StringView resRef, const ResourceDesc& type)
+{
+	// mark them, so they can't clash with plain class IDs
+	LookupKey key { std::string(resRef.c_str(), resRef.length()), (uint64_t(1) << 63) | type.GetKeyType() };
+	key.name.push_back('.');
+	key.name += type.GetExt();
+	StringToLower(key.name);
+	return key;
+}
+
+template<typename TYPE>
+size_t ResourceManager::FindSource(const SearchPath& path, StringView resRef, const TYPE& type, size_t start)
+{
+	const auto& sources = path.sources;
+	const auto& volatileSources = path.volatileSources;
+	// retries after failed loads just do a plain search
+	if (start > 0) {
+		for (size_t i = start; i < sources.size(); ++i) {
+			if (sources[i]->HasResource(resRef, type)) {
+				return i;
+			}
+		}
+		return InvalidSource;
+	}
+
+	LookupKey key = MakeLookupKey(resRef, type);
+	size_t cached = InvalidSource;
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(path.lookupsMutex);
+		auto lookup = path.lookups.find(key);
+		if (lookup != path.lookups.end()) {
+			cached = lookup->second;
+			found = true;
+		}
+	}
+
+	if (!found) {
+		for (size_t i = 0; i < sources.size(); ++i) {
+			if (!volatileSources[i] && sources[i]->HasResource(resRef, type)) {
+				cached = i;
+				break;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(path.lookupsMutex);
+		// plenty for all the game data, but keep it bounded anyway
+		if (path.lookups.size() >= 65536) {
+			path.lookups.clear();
+		}
+		path.lookups.emplace(std::move(key), cached);
+	}
+
+	// the volatile sources before the memoized one still need to be asked
+	for (size_t i = 0; i < sources.size() && i < cached; ++i) {
+		if (volatileSources[i] && sources[i]->HasResource(resRef, type)) {
+			return i;
+		}
+	}
+	return cached;
 }
 
 static void PrintPossibleFiles(std::string& buffer, StringView ResRef, const TypeID* type)
@@ -126,11 +216,8 @@ bool ResourceManager::Exists(StringView ResRef, SClass_ID type, bool silent) con
 {
 	if (ResRef.empty())
 		return false;
-	// TODO: check various caches
-	for (const auto& path : searchPath) {
-		if (path->HasResource(ResRef, type)) {
-			return true;
-		}
+	if (FindSource(*GetSearchPath(), ResRef, type) != InvalidSource) {
+		return true;
 	}
 	if (!silent) {
 		Log(WARNING, "ResourceManager", "'{}.{}' not found...",
@@ -143,13 +230,11 @@ bool ResourceManager::Exists(StringView ResRef, const TypeID* type, bool silent)
 {
 	if (ResRef.empty())
 		return false;
-	// TODO: check various caches
 	const std::vector<ResourceDesc>& types = PluginMgr::Get()->GetResourceDesc(type);
+	auto path = GetSearchPath();
 	for (const auto& type2 : types) {
-		for (const auto& path : searchPath) {
-			if (path->HasResource(ResRef, type2)) {
-				return true;
-			}
+		if (FindSource(*path, ResRef, type2) != InvalidSource) {
+			return true;
 		}
 	}
 	if (!silent) {
@@ -164,7 +249,10 @@ DataStream* ResourceManager::GetResourceStream(StringView ResRef, SClass_ID type
 {
 	if (ResRef.empty())
 		return nullptr;
-	for (const auto& path : searchPath) {
+	auto snapshot = GetSearchPath();
+	size_t idx = FindSource(*snapshot, ResRef, type);
+	while (idx != InvalidSource) {
+		const auto& path = snapshot->sources[idx];
 		DataStream* ds = path->GetResource(ResRef, type);
 		if (ds) {
 			if (!silent) {
@@ -172,6 +260,7 @@ DataStream* ResourceManager::GetResourceStream(StringView ResRef, SClass_ID type
 			}
 			return ds;
 		}
+		idx = FindSource(*snapshot, ResRef, type, idx + 1);
 	}
 	if (!silent) {
 		Log(ERROR, "ResourceManager", "Couldn't find '{}.{}'.", ResRef, TypeExt(type));
@@ -193,8 +282,11 @@ ResourceHolder<Resource> ResourceManager::GetResource(StringView ResRef, const T
 		std::sort(types2.begin(), types2.end(), [&prefferedType](auto& a, auto& b) { return (a.GetKeyType() == prefferedType ? true : (a.GetKeyType() < b.GetKeyType())); });
 	}
 
+	auto snapshot = GetSearchPath();
 	for (const auto& type2 : types2) {
-		for (const auto& path : searchPath) {
+		size_t idx = FindSource(*snapshot, ResRef, type2);
+		for (; idx != InvalidSource; idx = FindSource(*snapshot, ResRef, type2, idx + 1)) {
+			const auto& path = snapshot->sources[idx];
 			DataStream* str = path->GetResource(ResRef, type2);
 			if (!str) continue;
 
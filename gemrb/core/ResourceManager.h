@@ -30,12 +30,17 @@
 #include "System/VFS.h"
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace GemRB {
 
 #define RM_REPLACE_SAME_SOURCE 1
+// the contents can change while running (eg. the cache), so lookups in it are never memoized
+#define RM_VOLATILE_SOURCE 2
 
+class ResourceDesc;
 class ResourceSource;
 class TypeID;
 
@@ -49,6 +54,8 @@ public:
 	 * @param[in] type Plugin type used for source.
 	 **/
 	bool AddSource(const path_t& path, const std::string& description, PluginID type, int flags = 0);
+	/** Add an already opened ResourceSource to search path */
+	void AddSource(PluginHolder<ResourceSource> source, int flags = 0);
 
 	/** returns true if resource exists */
 	bool Exists(const String& resRef, SClass_ID type, bool silent = false) const;
@@ -67,7 +74,46 @@ private:
 	/** Returns Resource object associated to given resource */
 	ResourceHolder<Resource> GetResource(StringView resname, const TypeID* type, bool silent = false, ieWord prefferedType = 0) const;
 
-	std::vector<PluginHolder<ResourceSource>> searchPath;
+	// memoized lookups in the non-volatile sources, including misses
+	struct LookupKey {
+		std::string name;
+		uint64_t type;
+
+		bool operator==(const LookupKey& other) const
+		{
+			return type == other.type && name == other.name;
+		}
+	};
+
+	struct LookupKeyHash {
+		size_t operator()(const LookupKey& key) const
+		{
+			return std::hash<std::string>()(key.name) ^ std::hash<uint64_t>()(key.type);
+		}
+	};
+
+	// resources are also requested from the audio and preloading threads, so the
+	// search path is only ever replaced as a whole and they keep using their copy
+	struct SearchPath {
+		std::vector<PluginHolder<ResourceSource>> sources;
+		std::vector<bool> volatileSources;
+
+		// the indices are only valid for this search path
+		mutable std::unordered_map<LookupKey, size_t, LookupKeyHash> lookups;
+		mutable std::mutex lookupsMutex;
+	};
+
+	static constexpr size_t InvalidSource = size_t(-1);
+	std::shared_ptr<const SearchPath> searchPath = std::make_shared<const SearchPath>();
+	mutable std::mutex searchPathMutex;
+
+	std::shared_ptr<const SearchPath> GetSearchPath() const;
+
+	static LookupKey MakeLookupKey(StringView resRef, SClass_ID type);
+	static LookupKey MakeLookupKey(StringView resRef, const ResourceDesc& type);
+	/** Returns the index of the first source (from start on) that has the resource */
+	template<typename TYPE>
+	static size_t FindSource(const SearchPath& path, StringView resRef, const TYPE& type, size_t start = 0);
 };
 
 }
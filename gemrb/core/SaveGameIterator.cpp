@@ -140,7 +140,7 @@ SaveGame::SaveGame(path_t path, const path_t& name, const ResRef& prefix, std::s
 	} else {
 		Date = "n/a";
 	}
-	manager.AddSource(Path, name, PLUGIN_RESOURCE_DIRECTORY);
+	manager.AddSource(Path, name, PLUGIN_RESOURCE_DIRECTORY, RM_VOLATILE_SOURCE);
 	Name = StringFromUtf8(name);
 }
 
@@ -345,6 +345,9 @@ Actor::~Actor(void)
 	delete attackProjectile;
 	delete polymorphCache;
 
+	for (auto& wi : weaponInfo) {
+		Inventory::ReleaseWeaponInfo(wi);
+	}
 	free(spellStates);
 }
 
@@ -571,6 +574,7 @@ void Actor::SetCircleSize()
 	int csize = Clamp(anims->GetCircleSize(), 1, MAX_CIRCLE_SIZE) - 1;
 	int selectedIdx = (normalIdx == 0) ? 3 : normalIdx;
 	SetCircle(anims->GetCircleSize(), oscillationFactor, color, core->GroundCircles[csize][normalIdx], core->GroundCircles[csize][selectedIdx]);
+	if (area) area->UpdateActorGrid(this);
 }
 
 static void ApplyClabEntry(Actor* actor, const ieVariable& res, bool remove)
@@ -2515,6 +2519,10 @@ bool Actor::SetStat(unsigned int StatIndex, stat_t Value, int pcf)
 	unsigned int previous = GetSafeStat(StatIndex);
 	if (Modified[StatIndex] != Value) {
 		Modified[StatIndex] = Value;
+		// effect refreshes are compared as a whole at their end
+		if (!PrevStats && area && ActorStatIndex::IsIndexed(StatIndex)) {
+			area->ActorStatsChanged();
+		}
 	}
 	if (previous != Value) {
 		if (pcf) {
@@ -2706,7 +2714,66 @@ void Actor::AddEffects(EffectQueue&& fx)
 	RefreshEffects(first, prev);
 }
 
-void Actor::RefreshEffects(bool first, const stats_t& previous)
+// only for effects that merely modify stats, since anything else may depend on time, chance or the surroundings
+bool Actor::ReuseEffectStats() const
+{
+	if (!effectStats.valid) return false;
+
+	const Game* game = core->GetGame();
+	if (!game || game->GameTime >= effectStats.validUntil) return false;
+	if ((PCStats != nullptr) != effectStats.hasPortraitIcons) return false;
+	return BaseStats == effectStats.base && fxqueue.HasStatInputs(effectStats.inputs);
+}
+
+void Actor::CacheEffectStats(const stats_t& base)
+{
+	effectStats.valid = false;
+	// effects that change the base stats are applied just once anyway
+	const Game* game = core->GetGame();
+	if (!game || BaseStats != base) return;
+
+	effectStats.validUntil = UINT32_MAX;
+	if (!fxqueue.GetStatInputs(effectStats.inputs, effectStats.validUntil)) return;
+	if (game->GameTime >= effectStats.validUntil) return;
+
+	effectStats.base = base;
+	effectStats.modified = Modified;
+	effectStats.ac = AC;
+	effectStats.toHit = ToHit;
+	effectStats.hasPortraitIcons = PCStats != nullptr;
+	if (PCStats) {
+		effectStats.portraitIcons = PCStats->States;
+	}
+	effectStats.spellStates.assign(spellStates, spellStates + SpellStatesSize);
+	effectStats.valid = true;
+}
+
+void Actor::RestoreEffectStats()
+{
+	Modified = effectStats.modified;
+	// only the boni, the base values are part of the base stats
+	const ArmorClass& ac = effectStats.ac;
+	AC.SetDeflectionBonus(ac.GetDeflectionBonus());
+	AC.SetArmorBonus(ac.GetArmorBonus());
+	AC.SetShieldBonus(ac.GetShieldBonus());
+	AC.SetDexterityBonus(ac.GetDexterityBonus());
+	AC.SetWisdomBonus(ac.GetWisdomBonus());
+	AC.SetGenericBonus(ac.GetGenericBonus());
+	const ToHitStats& toHit = effectStats.toHit;
+	ToHit.SetWeaponBonus(toHit.GetWeaponBonus());
+	ToHit.SetArmorBonus(toHit.GetArmorBonus());
+	ToHit.SetShieldBonus(toHit.GetShieldBonus());
+	ToHit.SetAbilityBonus(toHit.GetAbilityBonus());
+	ToHit.SetProficiencyBonus(toHit.GetProficiencyBonus());
+	ToHit.SetGenericBonus(toHit.GetGenericBonus());
+	ToHit.SetFxBonus(toHit.GetFxBonus());
+	if (PCStats) {
+		PCStats->States = effectStats.portraitIcons;
+	}
+	std::copy(effectStats.spellStates.begin(), effectStats.spellStates.end(), spellStates);
+}
+
+void Actor::RefreshEffects(bool first, const stats_t& previous, bool cacheable)
 {
 	// some VVCs are controlled by stats (and so by PCFs), the rest have 'effect_owned' set
 	for (ScriptedAnimation* vvc : vfxQueue) {
@@ -2733,7 +2800,16 @@ void Actor::RefreshEffects(bool first, const stats_t& previous)
 		}
 	}
 
-	fxqueue.ApplyAllEffects(this);
+	if (cacheable && ReuseEffectStats()) {
+		RestoreEffectStats();
+	} else if (cacheable) {
+		stats_t base = BaseStats;
+		fxqueue.ApplyAllEffects(this);
+		CacheEffectStats(base);
+	} else {
+		fxqueue.ApplyAllEffects(this);
+		effectStats.valid = false;
+	}
 
 	const Game* game = core->GetGame();
 	if (previous[IE_PUPPETID]) {
@@ -2743,6 +2819,10 @@ void Actor::RefreshEffects(bool first, const stats_t& previous)
 	//move this further down if needed
 	PrevStats = NULL;
 
+	if (area && ActorStatIndex::AnyChanged(previous.data(), Modified.data())) {
+		area->ActorStatsChanged();
+	}
+
 	for (auto& trigger : triggers) {
 		trigger.flags |= TEF_PROCESSED_EFFECTS;
 
@@ -2868,7 +2948,7 @@ void Actor::RefreshEffects(bool first, const stats_t& previous)
 void Actor::RefreshEffects()
 {
 	bool first = !(InternalFlags & IF_INITIALIZED); //initialize base stats
-	RefreshEffects(first, ResetStats(first));
+	RefreshEffects(first, ResetStats(first), !first);
 }
 
 int Actor::GetProficiency(ieByte proftype) const
@@ -9354,21 +9434,23 @@ bool Actor::UseItemPoint(ieDword slot, int header, const Point& target, ieDword
 		Log(WARNING, "Actor", "Invalid quick slot item: {}!", itemRef);
 		return false; //quick item slot contains invalid item resref
 	}
-	gamedata->FreeItem(itm, itemRef, false);
 
 	if (!TryUsingMagicDevice(itm, header)) {
 		ChargeItem(slot, header, item, itm, flags & UI_SILENT, !(flags & UI_NOCHARGE));
+		gamedata->FreeItem(itm, itemRef, false);
 		AuraCooldown = core->Time.attack_round_size;
 		return false;
 	}
 
 	//item is depleted for today
 	if (itm->UseCharge(item->Usages, header, false) == CHG_DAY) {
+		gamedata->FreeItem(itm, itemRef, false);
 		return false;
 	}
 
 	Projectile* pro = itm->GetProjectile(this, header, target, slot, flags & UI_MISS);
 	ChargeItem(slot, header, item, itm, flags & UI_SILENT, !(flags & UI_NOCHARGE));
+	gamedata->FreeItem(itm, itemRef, false);
 	if (!(flags & UI_NOAURA)) {
 		AuraCooldown = core->Time.attack_round_size;
 	}
@@ -9693,16 +9775,17 @@ bool Actor::UseItem(ieDword slot, int header, const Scriptable* target, ieDword
 		Log(WARNING, "Actor", "Invalid quick slot item: {}!", itemRef);
 		return false; //quick item slot contains invalid item resref
 	}
-	gamedata->FreeItem(itm, itemRef, false);
 
 	if (!TryUsingMagicDevice(itm, header)) {
 		ChargeItem(slot, header, item, itm, flags & UI_SILENT, !(flags & UI_NOCHARGE));
+		gamedata->FreeItem(itm, itemRef, false);
 		AuraCooldown = core->Time.attack_round_size;
 		return false;
 	}
 
 	//item is depleted for today
 	if (itm->UseCharge(item->Usages, header, false) == CHG_DAY) {
+		gamedata->FreeItem(itm, itemRef, false);
 		return false;
 	}
 
@@ -9714,11 +9797,16 @@ bool Actor::UseItem(ieDword slot, int header, const Scriptable* target, ieDword
 	ieDword projectileAnim = 0;
 	if (header < 0 && !(flags & UI_MISS)) { // using a weapon
 		const ITMExtHeader* which = itm->GetWeaponHeader(ranged);
-		if (!which) return false; // eg. misc8u equipped by saemon havarian (ppsaem3), part of the silver sword and actually has a header, just untyped
+		if (!which) {
+			// eg. misc8u equipped by saemon havarian (ppsaem3), part of the silver sword and actually has a header, just untyped
+			gamedata->FreeItem(itm, itemRef, false);
+			return false;
+		}
 		weaponTypeIdx = which->DamageType;
 		projectileAnim = which->ProjectileAnimation;
 	}
 	ChargeItem(slot, header, item, itm, flags & UI_SILENT, !(flags & UI_NOCHARGE));
+	gamedata->FreeItem(itm, itemRef, false);
 
 	if (!(flags & UI_NOAURA)) {
 		AuraCooldown = core->Time.attack_round_size;
@@ -9775,7 +9863,14 @@ void Actor::ChargeItem(ieDword slot, int header, CREItem* item, const Item* itm,
 		item = inventory.GetSlotItem(slot);
 		if (!item)
 			return;
-		itm = gamedata->GetItem(item->ItemResRef, true);
+		// the caller doesn't hold the item, so get our own reference for the duration
+		ResRef itemRef = item->ItemResRef;
+		itm = gamedata->GetItem(itemRef, true);
+		if (itm) {
+			ChargeItem(slot, header, item, itm, silent, expend);
+			gamedata->FreeItem(itm, itemRef, false);
+			return;
+		}
 	}
 	if (!itm) {
 		Log(WARNING, "Actor", "Invalid quick slot item: {}!", item->ItemResRef);
@@ -554,6 +554,21 @@ private:
 	bool secondround = false; // true every second round of attack
 	int attacksperround = 0;
 
+	// the stats the effects produced last time, reused while neither they nor the base stats change
+	struct {
+		bool valid = false;
+		ieDword validUntil = 0;
+		stats_t base {};
+		stats_t modified {};
+		std::vector<EffectQueue::StatInput> inputs;
+		// the rest of what ResetStats clears and the effects rebuild
+		ArmorClass ac;
+		ToHitStats toHit;
+		bool hasPortraitIcons = false; // only with PCStats
+		PCStatsStruct::StateArray portraitIcons {};
+		std::vector<ieDword> spellStates;
+	} effectStats;
+
 	/** paint the actor itself. Called internally by Draw() */
 	void DrawActorSprite(const Point& p, BlitFlags flags,
 			     const std::vector<AnimationPart>& anims, const Color& tint) const;
@@ -604,7 +619,10 @@ private:
 	bool ProcessKillXP(const Actor* killerActor, bool grantXP);
 
 	stats_t ResetStats(bool init);
-	void RefreshEffects(bool init, const stats_t& prev);
+	void RefreshEffects(bool init, const stats_t& prev, bool cacheable = false);
+	bool ReuseEffectStats() const;
+	void CacheEffectStats(const stats_t& base);
+	void RestoreEffectStats();
 
 public:
 	using BlockingSizeCategory = uint8_t;
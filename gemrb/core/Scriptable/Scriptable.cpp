@@ -36,6 +36,7 @@
 #include "GameScript/Matching.h" // MatchActor
 #include "Scriptable/Highlightable.h"
 
+#include <unordered_map>
 #include <utility>
 
 namespace GemRB {
@@ -48,6 +49,14 @@ static bool pst_flags = false;
 static const unsigned short ClearActionsID = 133; // same for all games
 unsigned int Scriptable::VOODOO_VISUAL_RANGE = 28;
 
+// every live scriptable by its global ID
+// never destroyed, since static objects may still release scriptables on exit
+static std::unordered_map<ScriptID, Scriptable*>& GlobalIDRegistry()
+{
+	static auto* registry = new std::unordered_map<ScriptID, Scriptable*>();
+	return *registry;
+}
+
 /***********************
  *  Scriptable Class   *
  ***********************/
@@ -61,6 +70,7 @@ Scriptable::Scriptable(ScriptableType type)
 	if (globalActorCounter == 0) {
 		error("Scriptable", "GlobalID overflowed, quitting due to too many actors.");
 	}
+	GlobalIDRegistry()[globalID] = this;
 
 	Type = type;
 	if (Type == ST_ACTOR) {
@@ -79,6 +89,7 @@ Scriptable::Scriptable(ScriptableType type)
 
 Scriptable::~Scriptable(void)
 {
+	GlobalIDRegistry().erase(globalID);
 	if (CurrentAction) {
 		ReleaseCurrentAction();
 	}
@@ -88,6 +99,13 @@ Scriptable::~Scriptable(void)
 	}
 }
 
+Scriptable* Scriptable::FindByGlobalID(ScriptID id)
+{
+	const auto& registry = GlobalIDRegistry();
+	auto lookup = registry.find(id);
+	return lookup == registry.end() ? nullptr : lookup->second;
+}
+
 ieDword Scriptable::GetLocal(const ieVariable& key, ieDword fallback) const
 {
 	auto lookup = locals.find(key);
@@ -130,6 +148,19 @@ void Scriptable::SetMap(Map* map)
 		error("Scriptable", "Invalid map set!");
 	}
 	area = map;
+	// the actor may have been added to the map (and moved) before getting here
+	if (map && Type == ST_ACTOR) {
+		map->UpdateActorGrid(static_cast<const Actor*>(this));
+	}
+}
+
+void Scriptable::SetPos(const NavmapPoint& pos)
+{
+	Pos = pos;
+	SMPos = SearchmapPoint(pos);
+	if (area && Type == ST_ACTOR) {
+		area->UpdateActorGrid(static_cast<const Actor*>(this));
+	}
 }
 
 //ai is nonzero if this is an actor currently in the party
@@ -205,7 +236,8 @@ void Scriptable::TickScripting()
 {
 	// Stagger script updates.
 	// but not for just loaded area scripts, ensuring they run first
-	if (Ticks % 16 != globalID % 16 && (Type != ST_AREA || Ticks > 1)) {
+	// and retry postponed ones on every tick until they get their turn
+	if (!ScriptDeferrals && Ticks % 16 != globalID % 16 && (Type != ST_AREA || Ticks > 1)) {
 		return;
 	}
 
@@ -227,14 +259,17 @@ void Scriptable::TickScripting()
 	bool needsUpdate = (!CurrentAction) || (TriggerCountdown > 0) || (IdleTicks > 15);
 
 	// Also do a script update if one was forced..
+	bool urgent = false;
 	if (InternalFlags & IF_FORCEUPDATE) {
 		needsUpdate = true;
+		urgent = true;
 		InternalFlags &= ~IF_FORCEUPDATE;
 	}
 	// also force it for on-screen actors
 	Region vp = core->GetGameControl()->Viewport();
-	if (!needsUpdate && vp.PointInside(Pos)) {
+	if (vp.PointInside(Pos)) {
 		needsUpdate = true;
+		urgent = true;
 	}
 
 	// Charmed actors don't get frequent updates.
@@ -244,9 +279,21 @@ void Scriptable::TickScripting()
 
 	if (!needsUpdate) {
 		IdleTicks++;
+		ScriptDeferrals = 0;
 		return;
 	}
 
+	// once the area is out of script time, only the important updates run right away:
+	// non-actors, fresh triggers, fighting or party members and anyone postponed for long enough
+	if (!urgent && Type == ST_ACTOR && area && triggers.empty() && ScriptDeferrals < 16) {
+		const Actor* actor = static_cast<Actor*>(this);
+		if (!actor->InParty && !objects.LastTarget && area->ScriptBudgetSpent()) {
+			ScriptDeferrals++;
+			return;
+		}
+	}
+	ScriptDeferrals = 0;
+
 	if (!triggers.empty()) {
 		TriggerCountdown = 5;
 	}
@@ -331,6 +378,7 @@ void Scriptable::ExecuteScript(int scriptCount)
 	}
 
 	bool continuing = false, done = false;
+	GameScript::ForgetTriggerResults();
 	for (scriptLevel = 0; scriptLevel < scriptCount; scriptLevel++) {
 		GameScript* script = Scripts[scriptLevel];
 		if (script) {
@@ -929,6 +977,7 @@ void Scriptable::CastSpellPointEnd(int level, bool keepStance)
 		return;
 	}
 	int nSpellType = spl->SpellType;
+	ResRef completionSound = spl->CompletionSound;
 	gamedata->FreeSpell(spl, SpellResRef, false);
 
 	Actor* caster = Scriptable::As<Actor>(this);
@@ -970,7 +1019,7 @@ void Scriptable::CastSpellPointEnd(int level, bool keepStance)
 
 	if (!keepStance) {
 		// yep, the original didn't use the casting channel for this!
-		core->GetAudioPlayback().Play(spl->CompletionSound, AudioPreset::Spatial, SFXChannel::Missile, Pos);
+		core->GetAudioPlayback().Play(completionSound, AudioPreset::Spatial, SFXChannel::Missile, Pos);
 	}
 
 	CreateProjectile(SpellResRef, 0, level, false);
@@ -1009,6 +1058,7 @@ void Scriptable::CastSpellEnd(int level, bool keepStance)
 		return;
 	}
 	int nSpellType = spl->SpellType;
+	ResRef completionSound = spl->CompletionSound;
 	gamedata->FreeSpell(spl, SpellResRef, false);
 
 	Actor* caster = Scriptable::As<Actor>(this);
@@ -1046,7 +1096,7 @@ void Scriptable::CastSpellEnd(int level, bool keepStance)
 	}
 
 	if (!keepStance) {
-		core->GetAudioPlayback().Play(spl->CompletionSound, AudioPreset::Spatial, SFXChannel::Missile, Pos);
+		core->GetAudioPlayback().Play(completionSound, AudioPreset::Spatial, SFXChannel::Missile, Pos);
 	}
 
 	//if the projectile doesn't need to follow the target, then use the target position
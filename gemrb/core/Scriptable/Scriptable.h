@@ -297,6 +297,8 @@ public:
 	ieDword ScriptTicks = 0;
 	// The number of times since TickScripting() tried to do anything.
 	ieDword IdleTicks = 0;
+	// The number of ticks a due script update was postponed, since the area was out of script time.
+	ieDword ScriptDeferrals = 0;
 	// The number of ticks since the last spellcast
 	ieDword AuraCooldown = 0;
 	// The countdown for forced activation by triggers.
@@ -401,6 +403,8 @@ public:
 	void CastSpellPointEnd(int level, bool keepStance);
 	void CastSpellEnd(int level, bool keepStance);
 	ScriptID GetGlobalID() const { return globalID; }
+	/** finds any live scriptable by its global ID, regardless of where it is */
+	static Scriptable* FindByGlobalID(ScriptID id);
 	/** timer functions (numeric ID, not saved) */
 	bool TimerActive(ieDword ID);
 	bool TimerExpired(ieDword ID);
@@ -410,11 +414,7 @@ public:
 	unsigned int GetVisualRange() const;
 	ieDword GetLocal(const ieVariable& key, ieDword fallback) const;
 	virtual std::string dump() const = 0;
-	void SetPos(const NavmapPoint& pos)
-	{
-		Pos = pos;
-		SMPos = SearchmapPoint(pos);
-	};
+	void SetPos(const NavmapPoint& pos);
 
 private:
 	/* used internally to handle start of spellcasting */
@@ -166,6 +166,11 @@ DataStream* DataStream::Clone() const noexcept
 	return NULL;
 }
 
+const void* DataStream::View(strpos_t /*len*/)
+{
+	return NULL;
+}
+
 void DataStream::SetBigEndianness(bool isBE) noexcept
 {
 	IsDataBigEndian = isBE;
@@ -205,6 +205,12 @@ public:
 	 *  Returns NULL on failure.
 	 **/
 	virtual DataStream* Clone() const noexcept;
+	/** Returns a pointer to the next len bytes and skips past them, without copying.
+	 *
+	 *  Returns NULL if the stream has no such direct access, use Read then.
+	 *  The data stays valid only as long as the stream does.
+	 **/
+	virtual const void* View(strpos_t len);
 
 	void SetBigEndianness(bool) noexcept;
 
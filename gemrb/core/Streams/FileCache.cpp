@@ -37,15 +37,26 @@ DataStream* CacheCompressedStream(DataStream* stream, const path_t& filename, in
 	path_t path = PathJoin(core->config.CachePath, fname);
 
 	if (overwrite || !FileExists(path)) {
+		// decompress to a temporary file first, so nobody ever sees a partial one
+		path_t tmpPath = path + ".tmp";
 		FileStream out;
-		if (!out.Create(path)) {
-			Log(ERROR, "FileCache", "Cannot write {}.", path);
+		if (!out.Create(tmpPath)) {
+			Log(ERROR, "FileCache", "Cannot write {}.", tmpPath);
 			return NULL;
 		}
 
 		PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
-		if (comp->Decompress(&out, stream, length) != GEM_OK)
+		if (comp->Decompress(&out, stream, length) != GEM_OK) {
+			out.Close();
+			UnlinkFile(tmpPath);
 			return NULL;
+		}
+		out.Close(); // windows won't rename open files
+		if (!RenameFile(tmpPath, path)) {
+			Log(ERROR, "FileCache", "Cannot write {}.", path);
+			UnlinkFile(tmpPath);
+			return NULL;
+		}
 	} else {
 		stream->Seek(length, GEM_CURRENT_POS);
 	}
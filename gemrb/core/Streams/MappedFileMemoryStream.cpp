@@ -28,17 +28,13 @@
 
 namespace GemRB {
 
-MappedFileMemoryStream::MappedFileMemoryStream(const std::string& fileName)
-	: MemoryStream(fileName.c_str(), nullptr, 0),
-	  fileHandle(nullptr),
-	  fileOpened(false),
-	  fileMapped(false)
+MappedFileMemoryStream::FileMapping::FileMapping(const std::string& fileName)
 {
 #ifdef WIN32
 	TCHAR t_name[MAX_PATH] = { 0 };
 	mbstowcs(t_name, fileName.c_str(), MAX_PATH - 1);
 
-	this->fileHandle =
+	HANDLE handle =
 		CreateFile(
 			t_name,
 			GENERIC_READ,
@@ -47,45 +43,94 @@ MappedFileMemoryStream::MappedFileMemoryStream(const std::string& fileName)
 			OPEN_EXISTING,
 			FILE_ATTRIBUTE_NORMAL,
 			nullptr);
-	this->fileOpened = fileHandle != INVALID_HANDLE_VALUE;
-
-	if (fileOpened) {
-		LARGE_INTEGER fileSize;
-		GetFileSizeEx(fileHandle, &fileSize);
-		assert(fileSize.QuadPart <= ULONG_MAX);
-		size = static_cast<strpos_t>(fileSize.QuadPart);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return;
 	}
+	fileHandle = handle;
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	assert(fileSize.QuadPart <= ULONG_MAX);
+	size = static_cast<strpos_t>(fileSize.QuadPart);
 #else
-	this->fileHandle = fopen(fileName.c_str(), "rb");
-	this->fileOpened = fileHandle != nullptr;
-
-	if (fileOpened) {
-		struct stat statData {};
-		int ret = fstat(fileno(static_cast<FILE*>(fileHandle)), &statData);
-		assert(ret != -1);
-		this->size = statData.st_size;
+	fileHandle = fopen(fileName.c_str(), "rb");
+	if (!fileHandle) {
+		return;
+	}
+
+	struct stat statData {};
+	int ret = fstat(fileno(static_cast<FILE*>(fileHandle)), &statData);
+	assert(ret != -1);
+	size = statData.st_size;
+#endif
+
+	void* start = readonly_mmap(fileHandle);
+#ifndef WIN32
+	if (start == MAP_FAILED) {
+		start = nullptr;
 	}
 #endif
+	data = static_cast<char*>(start);
+}
+
+MappedFileMemoryStream::FileMapping::~FileMapping()
+{
+	if (data) {
+		munmap(data, size);
+	}
 
-	if (fileOpened) {
-		this->data = static_cast<char*>(readonly_mmap(fileHandle));
-		this->fileMapped = data != nullptr;
+	if (fileHandle) {
+#ifdef WIN32
+		CloseHandle(fileHandle);
+#else
+		fclose(static_cast<FILE*>(fileHandle));
+#endif
 	}
 }
 
+MappedFileMemoryStream::MappedFileMemoryStream(const std::string& fileName)
+	: MemoryStream(fileName.c_str(), nullptr, 0),
+	  mapping(std::make_shared<const FileMapping>(fileName))
+{
+	this->data = mapping->data;
+	this->size = mapping->size;
+}
+
+MappedFileMemoryStream::MappedFileMemoryStream(std::shared_ptr<const FileMapping> mapping, const path_t& fileName, strpos_t offset, strpos_t len)
+	: MemoryStream(fileName, nullptr, 0),
+	  mapping(std::move(mapping)),
+	  offset(offset)
+{
+	this->data = this->mapping->data ? this->mapping->data + offset : nullptr;
+	this->size = len;
+}
+
 bool MappedFileMemoryStream::isOk() const
 {
-	return fileOpened && fileMapped;
+	return data != nullptr;
 }
 
 DataStream* MappedFileMemoryStream::Clone() const noexcept
 {
-	return new MappedFileMemoryStream(originalfile);
+	auto clone = new MappedFileMemoryStream(mapping, originalfile, offset, size);
+	clone->filename = filename;
+	return clone;
+}
+
+DataStream* MappedFileMemoryStream::Slice(strpos_t startPos, strpos_t len) const
+{
+	if (!isOk() || startPos + len > size) {
+		return nullptr;
+	}
+
+	auto slice = new MappedFileMemoryStream(mapping, originalfile, offset + startPos, len);
+	slice->filename = filename;
+	return slice;
 }
 
 strret_t MappedFileMemoryStream::Read(void* dest, strpos_t length)
 {
-	if (!fileMapped) {
+	if (!isOk()) {
 		return Error;
 	}
 
@@ -94,13 +139,22 @@ strret_t MappedFileMemoryStream::Read(void* dest, strpos_t length)
 
 stroff_t MappedFileMemoryStream::Seek(stroff_t pos, strpos_t startPos)
 {
-	if (!fileMapped) {
+	if (!isOk()) {
 		return InvalidPos;
 	}
 
 	return MemoryStream::Seek(pos, startPos);
 }
 
+const void* MappedFileMemoryStream::View(strpos_t length)
+{
+	if (!isOk()) {
+		return nullptr;
+	}
+
+	return MemoryStream::View(length);
+}
+
 strret_t MappedFileMemoryStream::Write(const void*, strpos_t)
 {
 	return Error;
@@ -108,19 +162,8 @@ strret_t MappedFileMemoryStream::Write(const void*, strpos_t)
 
 MappedFileMemoryStream::~MappedFileMemoryStream()
 {
-	if (fileMapped) {
-		munmap(data, size);
-	}
-
+	// the mapping is owned by FileMapping, don't let MemoryStream free it
 	this->data = nullptr;
-
-	if (fileOpened) {
-#ifdef WIN32
-		CloseHandle(fileHandle);
-#else
-		fclose(static_cast<FILE*>(fileHandle));
-#endif
-	}
 }
 
 }
@@ -21,6 +21,8 @@
 #include "DataStream.h"
 #include "MemoryStream.h"
 
+#include <memory>
+
 namespace GemRB {
 
 class GEM_EXPORT MappedFileMemoryStream : public MemoryStream {
@@ -33,12 +35,28 @@ public:
 	strret_t Read(void* dest, strpos_t len) override;
 	strret_t Seek(stroff_t pos, strpos_t startPos) override;
 	strret_t Write(const void* src, strpos_t len) override;
+	const void* View(strpos_t len) override;
 	DataStream* Clone() const noexcept override;
+	/** Returns a stream over a part of the file, sharing the mapping instead of copying */
+	DataStream* Slice(strpos_t startPos, strpos_t len) const;
 
 private:
-	void* fileHandle;
-	bool fileOpened;
-	bool fileMapped;
+	// the mapping is shared between clones and slices and unmapped with the last one
+	struct FileMapping {
+		void* fileHandle = nullptr;
+		char* data = nullptr;
+		strpos_t size = 0;
+
+		explicit FileMapping(const std::string& fileName);
+		FileMapping(const FileMapping&) = delete;
+		~FileMapping();
+		FileMapping& operator=(const FileMapping&) = delete;
+	};
+
+	std::shared_ptr<const FileMapping> mapping;
+	strpos_t offset = 0;
+
+	MappedFileMemoryStream(std::shared_ptr<const FileMapping> mapping, const path_t& fileName, strpos_t offset, strpos_t len);
 };
 
 }
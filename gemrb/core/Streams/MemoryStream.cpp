@@ -60,6 +60,18 @@ strret_t MemoryStream::Read(void* dest, strpos_t length)
 	return length;
 }
 
+const void* MemoryStream::View(strpos_t length)
+{
+	// encrypted data can't be handed out as is
+	if (Encrypted || Pos + length > size) {
+		return nullptr;
+	}
+
+	const char* view = data + Pos;
+	Pos += length;
+	return view;
+}
+
 strret_t MemoryStream::Write(const void* src, strpos_t length)
 {
 	if (Pos + length > size) {
@@ -21,6 +21,9 @@
 #include "SlicedStream.h"
 
 #include "MemoryStream.h"
+#if defined(SUPPORTS_MEMSTREAM)
+	#include "MappedFileMemoryStream.h"
+#endif
 
 #include "Logging/Logging.h"
 
@@ -97,6 +100,17 @@ stroff_t SlicedStream::Seek(stroff_t newpos, strpos_t type)
 
 DataStream* SliceStream(DataStream* str, strpos_t startpos, strpos_t size, bool preservepos)
 {
+#if defined(SUPPORTS_MEMSTREAM)
+	// mapped files can just be shared, no need to copy or reopen anything
+	const auto mapped = dynamic_cast<const MappedFileMemoryStream*>(str);
+	if (mapped) {
+		DataStream* slice = mapped->Slice(startpos, size);
+		if (slice) {
+			return slice;
+		}
+	}
+#endif
+
 	if (size <= 16384) {
 		// small (or empty) substream, just read it into a buffer instead of expensive file I/O
 		strpos_t oldpos;
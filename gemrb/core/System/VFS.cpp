@@ -616,6 +616,17 @@ bool UnlinkFile(const path_t& path)
 #endif
 }
 
+bool RenameFile(const path_t& from, const path_t& to)
+{
+#ifdef WIN32
+	auto wideFrom = StringFromUtf8(from);
+	auto wideTo = StringFromUtf8(to);
+	return MoveFileExW(reinterpret_cast<const wchar_t*>(wideFrom.c_str()), reinterpret_cast<const wchar_t*>(wideTo.c_str()), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
 bool RemoveDirectory(const path_t& path)
 {
 #ifdef WIN32
@@ -152,6 +152,8 @@ void munmap(void* start, size_t);
 
 GEM_EXPORT bool RemoveDirectory(const path_t& path);
 GEM_EXPORT bool UnlinkFile(const path_t& path);
+// replaces 'to' if it exists, atomically where the platform allows
+GEM_EXPORT bool RenameFile(const path_t& from, const path_t& to);
 
 class GEM_EXPORT DirectoryIterator {
 public:
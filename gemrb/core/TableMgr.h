@@ -69,16 +69,51 @@ public:
 		return QueryField(GetRowIndex(row), GetColumnIndex(column));
 	}
 
+	/** The field converted like strtol and strtoul would, importers may cache it */
+	virtual long QueryFieldLong(index_t row, index_t column) const
+	{
+		return strtol(QueryField(row, column).c_str(), nullptr, 0);
+	}
+
+	virtual unsigned long QueryFieldULong(index_t row, index_t column) const
+	{
+		return strtoul(QueryField(row, column).c_str(), nullptr, 0);
+	}
+
+	long QueryFieldLong(const key_t& row, const key_t& column) const
+	{
+		return QueryFieldLong(GetRowIndex(row), GetColumnIndex(column));
+	}
+
+	unsigned long QueryFieldULong(const key_t& row, const key_t& column) const
+	{
+		return QueryFieldULong(GetRowIndex(row), GetColumnIndex(column));
+	}
+
+	// same clamping as strtounsigned and strtosigned
 	template<typename RET_T, typename ROW_T, typename COL_T>
 	RET_T QueryFieldUnsigned(const ROW_T& row, const COL_T& column) const
 	{
-		return strtounsigned<RET_T>(QueryField(row, column).c_str());
+		static_assert(std::is_unsigned<RET_T>::value, "Type must be unsigned");
+		unsigned long ret = QueryFieldULong(row, column);
+		if (ret > std::numeric_limits<RET_T>::max()) {
+			return std::numeric_limits<RET_T>::max();
+		}
+		return static_cast<RET_T>(ret);
 	}
 
 	template<typename RET_T, typename ROW_T, typename COL_T>
 	RET_T QueryFieldSigned(const ROW_T& row, const COL_T& column) const
 	{
-		return strtosigned<RET_T>(QueryField(row, column).c_str());
+		static_assert(std::is_signed<RET_T>::value, "Type must be signed");
+		long ret = QueryFieldLong(row, column);
+		if (ret > std::numeric_limits<RET_T>::max()) {
+			return std::numeric_limits<RET_T>::max();
+		}
+		if (ret < std::numeric_limits<RET_T>::min()) {
+			return std::numeric_limits<RET_T>::min();
+		}
+		return static_cast<RET_T>(ret);
 	}
 
 	template<typename ROW_T, typename COL_T>
@@ -85,6 +85,7 @@ Door* TileMap::AddDoor(const ResRef& ID, const ieVariable& Name, unsigned int Fl
 	door->SetName(ID);
 	door->SetScriptName(Name);
 	doors.push_back(door);
+	objectGridDirty = true;
 	return door;
 }
 
@@ -98,7 +99,9 @@ Door* TileMap::GetDoor(size_t idx) const
 
 Door* TileMap::GetDoor(const Point& p) const
 {
-	for (Door* door : doors) {
+	for (Highlightable* object : GetObjectsNear(Region(p, Size()))) {
+		if (object->Type != ST_DOOR) continue;
+		Door* door = static_cast<Door*>(object);
 		if (door->HitTest(p)) return door;
 	}
 	return nullptr;
@@ -173,6 +176,7 @@ void TileMap::DrawOverlays(const Region& viewport, bool rain, BlitFlags flags)
 void TileMap::AddContainer(Container* c)
 {
 	containers.push_back(c);
+	objectGridDirty = true;
 }
 
 Container* TileMap::GetContainer(size_t idx) const
@@ -198,7 +202,9 @@ Container* TileMap::GetContainer(const ieVariable& Name) const
 //in this case, empty piles won't be found!
 Container* TileMap::GetContainer(const Point& position, int type) const
 {
-	for (Container* container : containers) {
+	for (Highlightable* object : GetObjectsNear(Region(position, Size()))) {
+		if (object->Type != ST_CONTAINER) continue;
+		Container* container = static_cast<Container*>(object);
 		if (type != -1 && type != container->containerType) {
 			continue;
 		}
@@ -255,6 +261,7 @@ int TileMap::CleanupContainer(Container* container)
 	for (size_t i = 0; i < containers.size(); i++) {
 		if (containers[i] == container) {
 			containers.erase(containers.begin() + i);
+			objectGridDirty = true;
 			delete container;
 			return 1;
 		}
@@ -291,13 +298,16 @@ InfoPoint* TileMap::AddInfoPoint(const ieVariable& Name, unsigned short Type, co
 		ip->BBox = outline->BBox;
 	//ip->Active = true; //set active on creation
 	infoPoints.push_back(ip);
+	objectGridDirty = true;
 	return ip;
 }
 
 //if detectable is set, then only detectable infopoints will be returned
 InfoPoint* TileMap::GetInfoPoint(const Point& p, bool skipSilent) const
 {
-	for (InfoPoint* infoPoint : infoPoints) {
+	for (Highlightable* object : GetObjectsNear(Region(p, Size()))) {
+		if (object->Type == ST_DOOR || object->Type == ST_CONTAINER) continue;
+		InfoPoint* infoPoint = static_cast<InfoPoint*>(object);
 		//these flags disable any kind of user interaction
 		//scripts can still access an infopoint by name
 		if (infoPoint->Flags & (INFO_DOOR | TRAP_DEACTIVATED))
@@ -380,6 +390,15 @@ InfoPoint* TileMap::AdjustNearestTravel(Point& p) const
 	return best;
 }
 
+std::vector<Highlightable*> TileMap::GetObjectsNear(const Region& rgn) const
+{
+	if (objectGridDirty) {
+		objectGrid.Build(GetMapSize(), doors, containers, infoPoints);
+		objectGridDirty = false;
+	}
+	return objectGrid.Query(rgn);
+}
+
 Size TileMap::GetMapSize() const
 {
 	return Size((XCellCount * 64), (YCellCount * 64));
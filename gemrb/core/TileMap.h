@@ -23,6 +23,7 @@
 
 #include "exports.h"
 
+#include "HighlightableGrid.h"
 #include "Polygon.h"
 #include "TileOverlay.h"
 
@@ -34,6 +35,7 @@ namespace GemRB {
 class Container;
 class Door;
 class DoorTrigger;
+class Highlightable;
 class InfoPoint;
 class TileObject;
 
@@ -82,6 +84,9 @@ public:
 	InfoPoint* AdjustNearestTravel(Point& p) const;
 	size_t GetInfoPointCount() const { return infoPoints.size(); }
 
+	/** the doors, containers and infopoints whose bounds touch rgn, in that order */
+	std::vector<Highlightable*> GetObjectsNear(const Region& rgn) const;
+
 	TileObject* AddTile(const ResRef& ID, const ieVariable& Name, unsigned int Flags,
 			    unsigned short* openindices, int opencount, unsigned short* closeindices, int closecount);
 	TileObject* GetTile(unsigned int idx);
@@ -103,6 +108,10 @@ private:
 	std::vector<Container*> containers;
 	std::vector<InfoPoint*> infoPoints;
 	std::vector<TileObject*> tiles;
+
+	// rebuilt lazily, since the importers only fill in the bounds after adding the objects
+	mutable HighlightableGrid objectGrid;
+	mutable bool objectGridDirty = true;
 };
 
 }
@@ -50,7 +50,9 @@ inline uint8_t* DecodeRLEData(const uint8_t* p, const Size& size, colorkey_t col
 	return buffer;
 }
 
-inline uint8_t* FindRLEPos(uint8_t* rledata, int pitch, const Point& p, colorkey_t ck)
+// works for both mutable and read-only (eg. mapped) data
+template<typename BYTE>
+inline BYTE* FindRLEPos(BYTE* rledata, int pitch, const Point& p, colorkey_t ck)
 {
 	int skipcount = p.y * pitch + p.x;
 	while (skipcount > 0) {
@@ -31,6 +31,9 @@ namespace GemRB {
 class GEM_EXPORT_T IndexedArchive : public Plugin {
 public:
 	virtual int OpenArchive(const path_t& filename) = 0;
+	/** Prepares the archive for fast opening (eg. decompresses it into the cache).
+	 *  Must be safe to call from other threads. */
+	virtual int CacheArchive(const path_t& /*filename*/) { return GEM_OK; }
 	virtual DataStream* GetStream(unsigned long Resource, unsigned long Type) = 0;
 };
 
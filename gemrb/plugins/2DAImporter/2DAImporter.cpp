@@ -91,6 +91,23 @@ bool p2DAImporter::Open(std::unique_ptr<DataStream> str)
 	}
 
 	assert(rows.size() < std::numeric_limits<index_t>::max());
+
+	// by-name lookups are common, on duplicates the first one wins like before
+	for (index_t index = 0; index < rowNames.size(); index++) {
+		if (!rowIndex.Contains(rowNames[index])) {
+			rowIndex.Set(rowNames[index], index);
+		}
+	}
+	for (index_t index = 0; index < colNames.size(); index++) {
+		if (!colIndex.Contains(colNames[index])) {
+			colIndex.Set(colNames[index], index);
+		}
+	}
+
+	for (const auto& row : rows) {
+		maxColumns = std::max(maxColumns, static_cast<index_t>(row.size()));
+	}
+	defNumber = ToNumber(defVal);
 	return true;
 }
 
@@ -134,24 +151,53 @@ const std::string& p2DAImporter::QueryDefault() const
 	return defVal;
 }
 
-p2DAImporter::index_t p2DAImporter::GetRowIndex(const key_t& key) const
+p2DAImporter::Number p2DAImporter::ToNumber(const std::string& field)
 {
-	for (index_t index = 0; index < rowNames.size(); index++) {
-		if (StringCompKey(rowNames[index], key)) {
-			return index;
+	Number number;
+	char* endpr = nullptr;
+	number.value = strtol(field.c_str(), &endpr, 0);
+	number.valid = endpr != field.c_str();
+	number.uvalue = strtoul(field.c_str(), nullptr, 0);
+	return number;
+}
+
+const p2DAImporter::Number& p2DAImporter::QueryNumber(index_t row, index_t column) const
+{
+	if (rows.size() <= row || maxColumns <= column) {
+		return defNumber;
+	}
+
+	if (numbers.size() <= column) {
+		numbers.resize(column + 1);
+	}
+	auto& numberColumn = numbers[column];
+	if (numberColumn.empty()) {
+		numberColumn.reserve(rows.size());
+		for (index_t i = 0; i < rows.size(); i++) {
+			numberColumn.push_back(ToNumber(QueryField(i, column)));
 		}
 	}
-	return npos;
+	return numberColumn[row];
+}
+
+long p2DAImporter::QueryFieldLong(index_t row, index_t column) const
+{
+	return QueryNumber(row, column).value;
+}
+
+unsigned long p2DAImporter::QueryFieldULong(index_t row, index_t column) const
+{
+	return QueryNumber(row, column).uvalue;
+}
+
+p2DAImporter::index_t p2DAImporter::GetRowIndex(const key_t& key) const
+{
+	return rowIndex.Get(key, npos);
 }
 
 p2DAImporter::index_t p2DAImporter::GetColumnIndex(const key_t& key) const
 {
-	for (index_t index = 0; index < colNames.size(); index++) {
-		if (StringCompKey(colNames[index], key)) {
-			return index;
-		}
-	}
-	return npos;
+	return colIndex.Get(key, npos);
 }
 
 const static std::string blank;
@@ -175,9 +221,8 @@ p2DAImporter::index_t p2DAImporter::FindTableValue(index_t col, long val, index_
 {
 	index_t max = GetRowCount();
 	for (index_t row = start; row < max; row++) {
-		const std::string& ret = QueryField(row, col);
-		long Value;
-		if (valid_signednumber(ret.c_str(), Value) && (Value == val))
+		const Number& number = QueryNumber(row, col);
+		if (number.valid && number.value == val)
 			return row;
 	}
 	return npos;
@@ -23,6 +23,8 @@
 
 #include "TableMgr.h"
 
+#include "Strings/StringMap.h"
+
 #include <vector>
 
 namespace GemRB {
@@ -36,6 +38,21 @@ private:
 	std::vector<cell_t> rowNames;
 	std::vector<row_t> rows;
 	std::string defVal;
+	StringMap<index_t> rowIndex;
+	StringMap<index_t> colIndex;
+
+	// fields converted to numbers, filled in a column at a time when first queried
+	struct Number {
+		long value = 0;
+		unsigned long uvalue = 0;
+		bool valid = false; // like valid_signednumber
+	};
+	mutable std::vector<std::vector<Number>> numbers;
+	Number defNumber;
+	index_t maxColumns = 0;
+
+	static Number ToNumber(const std::string& field);
+	const Number& QueryNumber(index_t row, index_t column) const;
 
 public:
 	static index_t npos;
@@ -53,6 +70,8 @@ public:
 		if it cannot return a value, it returns the default */
 	const std::string& QueryField(index_t row, index_t column) const override;
 	const std::string& QueryDefault() const override;
+	long QueryFieldLong(index_t row, index_t column) const override;
+	unsigned long QueryFieldULong(index_t row, index_t column) const override;
 
 	index_t GetRowIndex(const key_t& string) const override;
 	index_t GetColumnIndex(const key_t& string) const override;
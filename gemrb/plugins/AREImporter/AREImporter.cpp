@@ -727,6 +727,7 @@ void AREImporter::GetInfoPoint(DataStream* str, int idx, Map* map) const
 			SearchmapPoint below { sample };
 			PathMapFlags tmp = map->tileProps.QuerySearchMap(below);
 			map->tileProps.PaintSearchMap(below, tmp | PathMapFlags::PASSABLE);
+			map->InvalidatePathfinderData(below);
 		}
 	}
 }
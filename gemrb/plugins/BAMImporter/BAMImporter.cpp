@@ -149,11 +149,11 @@ BAMImporter::index_t BAMImporter::GetCycleSize(index_t cycle)
 	return cycles[cycle].FramesCount;
 }
 
-Holder<Sprite2D> BAMImporter::GetFrameInternal(const FrameEntry& frameInfo, bool RLESprite, uint8_t* data) const
+Holder<Sprite2D> BAMImporter::GetFrameInternal(const FrameEntry& frameInfo, bool RLESprite, const uint8_t* data) const
 {
 	Holder<Sprite2D> spr;
 	const Region& rgn = frameInfo.bounds;
-	uint8_t* dataBegin = data + frameInfo.location.dataOffset;
+	const uint8_t* dataBegin = data + frameInfo.location.dataOffset;
 
 	if (RLESprite) {
 		PixelFormat fmt = PixelFormat::RLE8Bit(palette, CompressedColorIndex);
@@ -256,19 +256,25 @@ std::shared_ptr<AnimationFactory> BAMImporter::GetAnimationFactory(const ResRef&
 	std::vector<Holder<Sprite2D>> animframes;
 
 	if (version == BAMVersion::V1) {
+		auto FLT = CacheFLT();
 		str->Seek(DataStart, GEM_STREAM_START);
 		strpos_t length = str->Remains();
 		if (length == 0) return nullptr;
 
-		auto FLT = CacheFLT();
-		uint8_t* data = (uint8_t*) malloc(length);
-		str->Read(data, length);
+		// decode straight from the (mapped) stream if possible
+		uint8_t* buffer = nullptr;
+		auto data = static_cast<const uint8_t*>(str->View(length));
+		if (!data) {
+			buffer = (uint8_t*) malloc(length);
+			str->Read(buffer, length);
+			data = buffer;
+		}
 
 		for (const auto& frameInfo : frames) {
 			bool RLECompressed = allowCompression && frameInfo.RLE;
 			animframes.push_back(GetFrameInternal(frameInfo, RLECompressed, data - DataStart));
 		}
-		free(data);
+		free(buffer);
 
 		return std::make_shared<AnimationFactory>(resref, std::move(animframes), cycles, std::move(FLT));
 	} else {
@@ -54,9 +54,11 @@ DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const path_t& pa
 #if !defined(SUPPORTS_MEMSTREAM)
 	fflush(stdout);
 #endif
+	// decompress to a temporary file first, so nobody ever sees a partial one
+	path_t tmpPath = path + ".tmp";
 	FileStream out;
-	if (!out.Create(path)) {
-		Log(ERROR, "BIFImporter", "Cannot write {}.", path);
+	if (!out.Create(tmpPath)) {
+		Log(ERROR, "BIFImporter", "Cannot write {}.", tmpPath);
 		return NULL;
 	}
 	size_t finalsize = 0;
@@ -66,6 +68,8 @@ DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const path_t& pa
 		compressed->ReadDword(declen);
 		compressed->ReadDword(complen);
 		if (comp->Decompress(&out, compressed, complen) != GEM_OK) {
+			out.Close();
+			UnlinkFile(tmpPath);
 			return NULL;
 		}
 		finalsize = out.GetPos();
@@ -74,6 +78,11 @@ DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const path_t& pa
 		}
 	}
 	out.Close(); // This is necessary, since windows won't open the file otherwise.
+	if (!RenameFile(tmpPath, path)) {
+		Log(ERROR, "BIFImporter", "Cannot write {}.", path);
+		UnlinkFile(tmpPath);
+		return NULL;
+	}
 #if defined(SUPPORTS_MEMSTREAM)
 	return new MappedFileMemoryStream { path };
 #else
@@ -92,58 +101,67 @@ DataStream* BIFImporter::DecompressBIF(DataStream* compressed, const path_t& /*p
 	return CacheCompressedStream(compressed, std::string(compressed->filename), complen);
 }
 
+// opens the original archive, decompressing it into the cache if needed
+DataStream* BIFImporter::OpenUncached(const path_t& path, const path_t& cachePath)
+{
+	char Signature[8];
+#if defined(SUPPORTS_MEMSTREAM)
+	auto file = new MappedFileMemoryStream { path };
+	if (!file->isOk()) {
+		delete file;
+		return nullptr;
+	}
+#else
+	FileStream* file = FileStream::OpenFile(path);
+	if (!file) {
+		return nullptr;
+	}
+#endif
+	if (file->Read(Signature, 8) == GEM_ERROR) {
+		delete file;
+		return nullptr;
+	}
+
+	DataStream* archive = nullptr;
+	if (strncmp(Signature, "BIF V1.0", 8) == 0) {
+		archive = DecompressBIF(file, cachePath);
+		delete file;
+	} else if (strncmp(Signature, "BIFCV1.0", 8) == 0) {
+		archive = DecompressBIFC(file, cachePath);
+		delete file;
+	} else if (strncmp(Signature, "BIFFV1  ", 8) == 0) {
+		file->Seek(0, GEM_STREAM_START);
+		archive = file;
+	} else {
+		delete file;
+	}
+	return archive;
+}
+
 int BIFImporter::OpenArchive(const path_t& path)
 {
 	delete stream;
 	stream = nullptr;
 
 	path_t cachePath = PathJoin(core->config.CachePath, ExtractFileFromPath(path));
-	char Signature[8];
 #if defined(SUPPORTS_MEMSTREAM)
-	auto cacheStream = new MappedFileMemoryStream { cachePath.c_str() };
-
-	if (!cacheStream->isOk()) {
+	auto cacheStream = new MappedFileMemoryStream { cachePath };
+	if (cacheStream->isOk()) {
+		stream = cacheStream;
+	} else {
 		delete cacheStream;
-
-		auto file = new MappedFileMemoryStream { path };
-		if (!file->isOk()) {
-			delete file;
+	}
 #else
 	stream = FileStream::OpenFile(cachePath);
-
-	if (!stream) {
-		FileStream* file = FileStream::OpenFile(path);
-		if (!file) {
 #endif
-			return GEM_ERROR;
-		}
-		if (file->Read(Signature, 8) == GEM_ERROR) {
-			delete file;
-			return GEM_ERROR;
-		}
 
-		if (strncmp(Signature, "BIF V1.0", 8) == 0) {
-			stream = DecompressBIF(file, cachePath.c_str());
-			delete file;
-		} else if (strncmp(Signature, "BIFCV1.0", 8) == 0) {
-			stream = DecompressBIFC(file, cachePath.c_str());
-			delete file;
-		} else if (strncmp(Signature, "BIFFV1  ", 8) == 0) {
-			file->Seek(0, GEM_STREAM_START);
-			stream = file;
-		} else {
-			delete file;
-			return GEM_ERROR;
-		}
-#if defined(SUPPORTS_MEMSTREAM)
-	} else {
-		stream = cacheStream;
-#endif
+	if (!stream) {
+		stream = OpenUncached(path, cachePath);
 	}
-
 	if (!stream)
 		return GEM_ERROR;
 
+	char Signature[8];
 	stream->Read(Signature, 8);
 
 	if (strncmp(Signature, "BIFFV1  ", 8) != 0) {
@@ -153,28 +171,71 @@ int BIFImporter::OpenArchive(const path_t& path)
 	return ReadBIF();
 }
 
+int BIFImporter::CacheArchive(const path_t& path)
+{
+	path_t cachePath = PathJoin(core->config.CachePath, ExtractFileFromPath(path));
+	if (FileExists(cachePath)) {
+		return GEM_OK;
+	}
+
+	// we only need the side effect of (not) decompressing it
+	DataStream* archive = OpenUncached(path, cachePath);
+	if (!archive) {
+		return GEM_ERROR;
+	}
+	delete archive;
+	return GEM_OK;
+}
+
+static constexpr ieDword FILE_LOCATOR_MASK = 0x3FFF;
+static constexpr ieDword TILE_LOCATOR_MASK = 0xFC000;
+static constexpr ieDword TILE_LOCATOR_SHIFT = 14;
+static constexpr ieDword NO_ENTRY = 0xffffffff;
+
 DataStream* BIFImporter::GetStream(unsigned long Resource, unsigned long Type)
 {
 	if (Type == IE_TIS_CLASS_ID) {
-		unsigned int srcResLoc = Resource & 0xFC000;
-		for (unsigned int i = 0; i < tentcount; i++) {
-			if ((tentries[i].resLocator & 0xFC000) == srcResLoc) {
-				return SliceStream(stream, tentries[i].dataOffset,
-						   tentries[i].tileSize * tentries[i].tilesCount);
-			}
+		ieDword srcResLoc = (Resource & TILE_LOCATOR_MASK) >> TILE_LOCATOR_SHIFT;
+		if (srcResLoc < tileIndex.size() && tileIndex[srcResLoc] != NO_ENTRY) {
+			const TileEntry& entry = tentries[tileIndex[srcResLoc]];
+			return SliceStream(stream, entry.dataOffset, entry.tileSize * entry.tilesCount);
 		}
 	} else {
-		ieDword srcResLoc = Resource & 0x3FFF;
-		for (ieDword i = 0; i < fentcount; i++) {
-			if ((fentries[i].resLocator & 0x3FFF) == srcResLoc) {
-				return SliceStream(stream, fentries[i].dataOffset,
-						   fentries[i].fileSize);
-			}
+		ieDword srcResLoc = Resource & FILE_LOCATOR_MASK;
+		if (srcResLoc < fileIndex.size() && fileIndex[srcResLoc] != NO_ENTRY) {
+			const FileEntry& entry = fentries[fileIndex[srcResLoc]];
+			return SliceStream(stream, entry.dataOffset, entry.fileSize);
 		}
 	}
 	return NULL;
 }
 
+// the locators are (almost always) just the entry indices, so a dense table is cheap
+void BIFImporter::BuildIndices()
+{
+	fileIndex.clear();
+	tileIndex.clear();
+	for (ieDword i = 0; i < fentcount; i++) {
+		ieDword resLoc = fentries[i].resLocator & FILE_LOCATOR_MASK;
+		if (resLoc >= fileIndex.size()) {
+			fileIndex.resize(resLoc + 1, NO_ENTRY);
+		}
+		// keep the first match, like the old linear search did
+		if (fileIndex[resLoc] == NO_ENTRY) {
+			fileIndex[resLoc] = i;
+		}
+	}
+	for (ieDword i = 0; i < tentcount; i++) {
+		ieDword resLoc = (tentries[i].resLocator & TILE_LOCATOR_MASK) >> TILE_LOCATOR_SHIFT;
+		if (resLoc >= tileIndex.size()) {
+			tileIndex.resize(resLoc + 1, NO_ENTRY);
+		}
+		if (tileIndex[resLoc] == NO_ENTRY) {
+			tileIndex[resLoc] = i;
+		}
+	}
+}
+
 int BIFImporter::ReadBIF()
 {
 	ieDword foffset;
@@ -205,6 +266,7 @@ int BIFImporter::ReadBIF()
 		stream->ReadWord(tentries[i].type);
 		stream->ReadWord(tentries[i].u1);
 	}
+	BuildIndices();
 	return GEM_OK;
 }
 
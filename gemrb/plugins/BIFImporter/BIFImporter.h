@@ -24,6 +24,8 @@
 #include "Plugins/IndexedArchive.h"
 #include "Streams/DataStream.h"
 
+#include <vector>
+
 namespace GemRB {
 
 struct FileEntry {
@@ -49,6 +51,9 @@ private:
 	TileEntry* tentries = nullptr;
 	ieDword fentcount = 0;
 	ieDword tentcount = 0;
+	// entry indices by the (masked) resource locator, for direct lookups
+	std::vector<ieDword> fileIndex;
+	std::vector<ieDword> tileIndex;
 	DataStream* stream = nullptr;
 
 public:
@@ -57,12 +62,15 @@ public:
 	~BIFImporter() override;
 	BIFImporter& operator=(const BIFImporter&) = delete;
 	int OpenArchive(const path_t& filename) override;
+	int CacheArchive(const path_t& filename) override;
 	DataStream* GetStream(unsigned long Resource, unsigned long Type) override;
 
 private:
 	static DataStream* DecompressBIF(DataStream* compressed, const path_t& path);
 	static DataStream* DecompressBIFC(DataStream* compressed, const path_t& path);
+	static DataStream* OpenUncached(const path_t& path, const path_t& cachePath);
 	int ReadBIF();
+	void BuildIndices();
 };
 
 }
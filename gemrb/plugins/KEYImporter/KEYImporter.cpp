@@ -26,6 +26,8 @@
 #include "Logging/Logging.h"
 #include "Streams/FileStream.h"
 
+#include <algorithm>
+
 using namespace GemRB;
 
 static path_t AddCBF(path_t file)
@@ -89,6 +91,75 @@ static void FindBIF(BIFEntry* entry)
 	Log(ERROR, "KEYImporter", "Cannot find {}...", entry->name);
 }
 
+KEYImporter::~KEYImporter()
+{
+	{
+		std::lock_guard<std::mutex> lock(precacheMutex);
+		precacheStop = true;
+	}
+	for (auto& thread : precacheThreads) {
+		thread.join();
+	}
+}
+
+void KEYImporter::StartPrecaching()
+{
+	precacheStates.assign(biffiles.size(), PrecacheState::Pending);
+
+	// decompression is mostly disk bound, so don't bother with too many workers
+	unsigned int workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+	workers = std::min(workers, 4U);
+	Log(MESSAGE, "KEYImporter", "Precaching archives with {} threads...", workers);
+	for (unsigned int i = 0; i < workers; i++) {
+		precacheThreads.emplace_back(&KEYImporter::PrecacheWorker, this);
+	}
+}
+
+void KEYImporter::PrecacheWorker()
+{
+	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
+	size_t bifnum = 0;
+	while (true) {
+		{
+			std::lock_guard<std::mutex> lock(precacheMutex);
+			while (bifnum < precacheStates.size() && precacheStates[bifnum] != PrecacheState::Pending) {
+				bifnum++;
+			}
+			if (precacheStop || bifnum >= precacheStates.size()) {
+				return;
+			}
+			precacheStates[bifnum] = PrecacheState::Running;
+		}
+
+		if (biffiles[bifnum].found && ai->CacheArchive(biffiles[bifnum].path) != GEM_OK) {
+			Log(WARNING, "KEYImporter", "Could not precache {}.", biffiles[bifnum].path);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(precacheMutex);
+			precacheStates[bifnum] = PrecacheState::Done;
+		}
+		precacheDone.notify_all();
+	}
+}
+
+void KEYImporter::WaitForPrecache(unsigned int bifnum)
+{
+	std::unique_lock<std::mutex> lock(precacheMutex);
+	if (bifnum >= precacheStates.size()) {
+		return;
+	}
+
+	// not started yet, so the regular opening will have to do it
+	if (precacheStates[bifnum] == PrecacheState::Pending) {
+		precacheStates[bifnum] = PrecacheState::Done;
+		return;
+	}
+	precacheDone.wait(lock, [this, bifnum]() {
+		return precacheStates[bifnum] == PrecacheState::Done;
+	});
+}
+
 bool KEYImporter::Open(const path_t& resfile, std::string desc)
 {
 	description = std::move(desc);
@@ -177,6 +248,10 @@ bool KEYImporter::Open(const path_t& resfile, std::string desc)
 
 	Log(MESSAGE, "KEYImporter", "Resources Loaded...");
 	delete f;
+
+	if (core->config.PrecacheArchives) {
+		StartPrecaching();
+	}
 	return true;
 }
 
@@ -190,6 +265,31 @@ bool KEYImporter::HasResource(StringView resname, const ResourceDesc& type)
 	return HasResource(resname, type.GetKeyType());
 }
 
+// must be called with archivesMutex held
+PluginHolder<IndexedArchive> KEYImporter::GetArchive(unsigned int bifnum)
+{
+	auto cached = std::find_if(archives.begin(), archives.end(), [bifnum](const KEYCache& entry) {
+		return entry.bifnum == bifnum;
+	});
+	if (cached != archives.end()) {
+		// move it to the front, so the least recently used one is evicted first
+		std::rotate(archives.begin(), cached, cached + 1);
+		return archives.front().plugin;
+	}
+
+	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
+	if (ai->OpenArchive(biffiles[bifnum].path) == GEM_ERROR) {
+		Log(ERROR, "KEYImporter", "Cannot open archive {}", biffiles[bifnum].path);
+		return nullptr;
+	}
+
+	if (archives.size() >= KEY_CACHE_SIZE) {
+		archives.pop_back();
+	}
+	archives.emplace(archives.begin(), bifnum, ai);
+	return ai;
+}
+
 DataStream* KEYImporter::GetStream(const ResRef& resname, ieWord type)
 {
 	if (type == 0)
@@ -213,9 +313,13 @@ DataStream* KEYImporter::GetStream(const ResRef& resname, ieWord type)
 		return NULL;
 	}
 
-	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
-	if (ai->OpenArchive(biffiles[bifnum].path) == GEM_ERROR) {
-		Log(ERROR, "KEYImporter", "Cannot open archive {}", biffiles[bifnum].path);
+	// don't decompress the same archive twice at the same time
+	WaitForPrecache(bifnum);
+
+	// the archive stream is shared, so the slicing has to be serialized too
+	std::lock_guard<std::mutex> lock(archivesMutex);
+	PluginHolder<IndexedArchive> ai = GetArchive(bifnum);
+	if (!ai) {
 		return NULL;
 	}
 
@@ -27,6 +27,9 @@
 #include "Plugins/IndexedArchive.h"
 #include "System/VFS.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -74,20 +77,53 @@ struct MapKeyHash {
 
 struct KEYCache {
 	KEYCache() { bifnum = 0xffffffff; }
+	KEYCache(unsigned int bifnum, PluginHolder<IndexedArchive> plugin)
+		: bifnum(bifnum), plugin(std::move(plugin)) {}
 
 	unsigned int bifnum;
 	PluginHolder<IndexedArchive> plugin;
 };
 
+// how many opened BIF archives we keep around, each holds a mapping / file handle
+static constexpr size_t KEY_CACHE_SIZE = 16;
+
 class KEYImporter : public ResourceSource {
 private:
+	// states of the background decompression of each BIF
+	enum class PrecacheState : uint8_t {
+		Pending,
+		Running,
+		Done
+	};
+
 	std::vector<BIFEntry> biffiles;
 	std::unordered_map<MapKey, ieDword, MapKeyHash> resources;
-
+	// opened archives, the most recently used one first
+	std::vector<KEYCache> archives;
+	// resources can also be requested from the audio threads
+	std::mutex archivesMutex;
+
+	std::vector<PrecacheState> precacheStates;
+	std::vector<std::thread> precacheThreads;
+	std::mutex precacheMutex;
+	std::condition_variable precacheDone;
+	bool precacheStop = false;
+
+	/** Decompresses compressed BIFs into the cache in the background */
+	void StartPrecaching();
+	void PrecacheWorker();
+	/** Waits for (or cancels) the background decompression of a BIF */
+	void WaitForPrecache(unsigned int bifnum);
+	/** Returns an opened archive for the given BIF, reusing cached ones */
+	PluginHolder<IndexedArchive> GetArchive(unsigned int bifnum);
 	/** Gets the stream associated to a RESKey */
 	DataStream* GetStream(const ResRef&, ieWord type);
 
 public:
+	KEYImporter() noexcept = default;
+	KEYImporter(const KEYImporter&) = delete;
+	~KEYImporter() override;
+	KEYImporter& operator=(const KEYImporter&) = delete;
 	bool Open(const path_t& file, std::string desc) override;
 	/* predicts the availability of a resource */
 	bool HasResource(StringView resname, SClass_ID type) override;
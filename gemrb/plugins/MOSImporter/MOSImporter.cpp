@@ -128,10 +128,9 @@ Holder<Sprite2D> MOSImporter::GetSprite2Dv2()
 
 Holder<Sprite2D> MOSImporter::GetSprite2Dv1()
 {
-	Color Col[256];
+	Color palBuffer[256];
 	unsigned char* pixels = (unsigned char*) malloc(size.Area() * 4);
-	unsigned char* blockpixels = (unsigned char*)
-		malloc(layout.v1.BlockSize * layout.v1.BlockSize);
+	unsigned char* blockBuffer = nullptr;
 	ieDword blockoffset;
 	const ieDword& PalOffset = layout.v1.PalOffset;
 
@@ -146,7 +145,12 @@ Holder<Sprite2D> MOSImporter::GetSprite2Dv1()
 			str->Seek(PalOffset + (y * Cols * 1024) +
 					  (x * 1024),
 				  GEM_STREAM_START);
-			str->Read(&Col[0], 1024);
+			// use the (mapped) data in place if we can
+			auto Col = static_cast<const Color*>(str->View(1024));
+			if (!Col) {
+				str->Read(&palBuffer[0], 1024);
+				Col = palBuffer;
+			}
 			str->Seek(PalOffset + (Rows * Cols * 1024) +
 					  (y * Cols * 4) + (x * 4),
 				  GEM_STREAM_START);
@@ -154,8 +158,14 @@ Holder<Sprite2D> MOSImporter::GetSprite2Dv1()
 			str->Seek(PalOffset + (Rows * Cols * 1024) +
 					  (Rows * Cols * 4) + blockoffset,
 				  GEM_STREAM_START);
-			str->Read(blockpixels, bw * bh);
-			const unsigned char* bp = blockpixels;
+			auto bp = static_cast<const unsigned char*>(str->View(bw * bh));
+			if (!bp) {
+				if (!blockBuffer) {
+					blockBuffer = (unsigned char*) malloc(layout.v1.BlockSize * layout.v1.BlockSize);
+				}
+				str->Read(blockBuffer, bw * bh);
+				bp = blockBuffer;
+			}
 			unsigned char* startpixel = pixels +
 				((size.w * 4 * y) * 64) +
 				(4 * x * 64);
@@ -175,7 +185,7 @@ Holder<Sprite2D> MOSImporter::GetSprite2Dv1()
 			}
 		}
 	}
-	free(blockpixels);
+	free(blockBuffer);
 
 	constexpr uint32_t red_mask = 0x00ff0000;
 	constexpr uint32_t green_mask = 0x0000ff00;
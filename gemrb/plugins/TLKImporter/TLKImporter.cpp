@@ -72,6 +72,7 @@ TLKImporter::~TLKImporter(void)
 
 void TLKImporter::CloseAux()
 {
+	ForgetAuxStrings();
 	if (OverrideTLK) {
 		delete OverrideTLK;
 	}
@@ -109,6 +110,27 @@ bool TLKImporter::Open(DataStream* stream)
 		return false;
 	}
 
+	cachedStrings.clear();
+	cacheQueue.clear();
+	entries.clear();
+	entries.reserve(StrRefCount);
+	for (ieDword i = 0; i < StrRefCount; i++) {
+		TLKEntry entry;
+		ieDword volume;
+		ieDword pitch;
+		str->ReadWord(entry.type);
+		str->ReadResRef(entry.sound);
+		// volume and pitch variance fields are known to be unused at minimum in bg1
+		str->ReadDword(volume);
+		str->ReadDword(pitch);
+		str->ReadDword(entry.offset);
+		if (str->ReadDword(entry.length) != 4) {
+			Log(WARNING, "TLKImporter", "Truncated TLK, only {} of {} strings present.", i, StrRefCount);
+			break;
+		}
+		entries.push_back(entry);
+	}
+
 	if (GetString(ieStrRef(1)).back() == u'\n') {
 		hasEndingNewline = true;
 	}
@@ -332,7 +354,58 @@ ieStrRef TLKImporter::UpdateString(ieStrRef strref, const String& newvalue)
 		return ieStrRef::INVALID;
 	}
 
-	return OverrideTLK->UpdateString(strref, newvalue);
+	ieStrRef newStrRef = OverrideTLK->UpdateString(strref, newvalue);
+	ForgetString(strref);
+	ForgetString(newStrRef);
+	return newStrRef;
+}
+
+const TLKImporter::CachedString* TLKImporter::LookupString(ieStrRef strref)
+{
+	auto lookup = cachedStrings.find(strref);
+	if (lookup == cachedStrings.end()) {
+		return nullptr;
+	}
+	cacheQueue.splice(cacheQueue.end(), cacheQueue, lookup->second.queuePos);
+	return &lookup->second;
+}
+
+const TLKImporter::CachedString& TLKImporter::CacheString(ieStrRef strref, String&& text)
+{
+	if (cachedStrings.size() >= MAX_CACHED_STRINGS) {
+		cachedStrings.erase(cacheQueue.front());
+		cacheQueue.pop_front();
+	}
+
+	CachedString& cached = cachedStrings[strref];
+	// anything ResolveTags would change or stop at
+	cached.hasTags = text.find_first_of(u"<%[\0", 0, 4) != String::npos;
+	cached.text = std::move(text);
+	cached.queuePos = cacheQueue.insert(cacheQueue.end(), strref);
+	return cached;
+}
+
+void TLKImporter::ForgetString(ieStrRef strref)
+{
+	auto lookup = cachedStrings.find(strref);
+	if (lookup == cachedStrings.end()) return;
+
+	cacheQueue.erase(lookup->second.queuePos);
+	cachedStrings.erase(lookup);
+}
+
+// the override strings come from the saved game, so they change with it
+void TLKImporter::ForgetAuxStrings()
+{
+	for (auto it = cacheQueue.begin(); it != cacheQueue.end();) {
+		ieStrRef strref = *it;
+		if (strref >= ieStrRef::OVERRIDE_START || (strref >= ieStrRef::BIO_START && strref <= ieStrRef::BIO_END)) {
+			cachedStrings.erase(strref);
+			it = cacheQueue.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 String TLKImporter::GetString(ieStrRef strref, STRING_FLAGS flags)
@@ -341,45 +414,52 @@ String TLKImporter::GetString(ieStrRef strref, STRING_FLAGS flags)
 	bool empty = !(flags & STRING_FLAGS::ALLOW_ZERO) && !strref;
 	ieWord type;
 	ResRef SoundResRef;
+	bool hasTags = true;
 
 	if (empty || strref >= ieStrRef::OVERRIDE_START || (strref >= ieStrRef::BIO_START && strref <= ieStrRef::BIO_END)) {
-		if (OverrideTLK) {
+		const CachedString* cached = empty ? nullptr : LookupString(strref);
+		if (cached) {
+			string = cached->text;
+			hasTags = cached->hasTags;
+		} else if (OverrideTLK) {
 			size_t Length;
 			char* cstr = OverrideTLK->ResolveAuxString(strref, Length);
 			string = StringFromTLK(StringView(cstr, Length));
 			free(cstr);
+			if (!empty) {
+				hasTags = CacheString(strref, String(string)).hasTags;
+			}
 		}
 		type = 0;
 		SoundResRef.Reset();
 	} else {
-		ieDword Volume, Pitch, StrOffset;
-		ieDword l;
-		if (str->Seek(18 + (ieDword(strref) * 0x1A), GEM_STREAM_START) == GEM_ERROR) {
+		if (ieDword(strref) >= entries.size()) {
 			return u"";
 		}
-		str->ReadWord(type);
-		str->ReadResRef(SoundResRef);
-		// volume and pitch variance fields are known to be unused at minimum in bg1
-		str->ReadDword(Volume);
-		str->ReadDword(Pitch);
-		str->ReadDword(StrOffset);
-		str->ReadDword(l);
+		const TLKEntry& entry = entries[ieDword(strref)];
+		type = entry.type;
+		SoundResRef = entry.sound;
 
-		if (l == 0) {
+		if (entry.length == 0) {
 			return u"";
 		}
 
 		if (type & 1) {
-			if (str->Seek(StrOffset + Offset, GEM_STREAM_START) == GEM_ERROR) {
-				return u"";
+			const CachedString* cached = LookupString(strref);
+			if (!cached) {
+				if (str->Seek(entry.offset + Offset, GEM_STREAM_START) == GEM_ERROR) {
+					return u"";
+				}
+				std::string mbstr(entry.length, '\0');
+				str->Read(&mbstr[0], entry.length);
+				cached = &CacheString(strref, StringFromTLK(mbstr));
 			}
-			std::string mbstr(l, '\0');
-			str->Read(&mbstr[0], l);
-			string = StringFromTLK(mbstr);
+			string = cached->text;
+			hasTags = cached->hasTags;
 		}
 	}
 
-	if (bool(flags & STRING_FLAGS::RESOLVE_TAGS) || (type & 4)) {
+	if ((bool(flags & STRING_FLAGS::RESOLVE_TAGS) || (type & 4)) && hasTags) {
 		string = ResolveTags(string);
 	}
 	if ((type & 2) && bool(flags & STRING_FLAGS::SOUND) && !SoundResRef.IsEmpty()) {
@@ -417,14 +497,10 @@ StringBlock TLKImporter::GetStringBlock(ieStrRef strref, STRING_FLAGS flags)
 	if (empty) {
 		return StringBlock();
 	}
-	ieWord type;
-	if (str->Seek(18 + (ieDword(strref) * 0x1A), GEM_STREAM_START) == GEM_ERROR) {
+	if (ieDword(strref) >= entries.size()) {
 		return StringBlock();
 	}
-	str->ReadWord(type);
-	ResRef soundRef;
-	str->ReadResRef(soundRef);
-	return StringBlock(GetString(strref, flags), soundRef);
+	return StringBlock(GetString(strref, flags), entries[ieDword(strref)].sound);
 }
 
 #include "plugindef.h"
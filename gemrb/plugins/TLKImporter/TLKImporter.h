@@ -26,6 +26,10 @@
 #include "StringMgr.h"
 #include "TlkOverride.h"
 
+#include <list>
+#include <unordered_map>
+#include <vector>
+
 namespace GemRB {
 
 struct gt_type {
@@ -36,7 +40,27 @@ struct gt_type {
 
 class TLKImporter : public StringMgr {
 private:
+	struct TLKEntry {
+		ieWord type = 0;
+		ResRef sound;
+		ieDword offset = 0;
+		ieDword length = 0;
+	};
+
+	// decoded text, before any tag resolution
+	struct CachedString {
+		String text;
+		bool hasTags = false;
+		std::list<ieStrRef>::iterator queuePos;
+	};
+
+	static constexpr size_t MAX_CACHED_STRINGS = 2048;
+
 	DataStream* str = nullptr;
+	// the entry table is small, so it's read just once
+	std::vector<TLKEntry> entries;
+	std::unordered_map<ieStrRef, CachedString> cachedStrings;
+	std::list<ieStrRef> cacheQueue; // least recently used first
 
 	//Data
 	ieWord Language = 0;
@@ -67,6 +91,10 @@ private:
 	/** resolves day and monthname tokens */
 	void GetMonthName(int dayandmonth);
 	String ResolveTags(const String& source);
+	const CachedString* LookupString(ieStrRef strref);
+	const CachedString& CacheString(ieStrRef strref, String&& text);
+	void ForgetString(ieStrRef strref);
+	void ForgetAuxStrings();
 	String BuiltinToken(const ieVariable& Token);
 	ieStrRef ClassStrRef(int slot) const;
 	ieStrRef RaceStrRef(int slot) const;
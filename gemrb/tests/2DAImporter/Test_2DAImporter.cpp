@@ -67,6 +67,19 @@ TEST_P(p2DAImporterTest, QueryField)
 	EXPECT_EQ(unit.QueryField(6, 3), std::string { "-1" });
 }
 
+TEST_P(p2DAImporterTest, QueryFieldNumbers)
+{
+	EXPECT_EQ(unit.QueryFieldSigned<int>(0, 0), 11975);
+	EXPECT_EQ(unit.QueryFieldSigned<int>(StringView("Dexterity"), StringView("cap_ref")), 1151);
+	EXPECT_EQ(unit.QueryFieldUnsigned<ieWord>(StringView("SQUEEZENESS"), StringView("DESC_REF")), ieWord(200));
+	// missing fields and non-numbers
+	EXPECT_EQ(unit.QueryFieldSigned<int>(6, 3), -1);
+	EXPECT_EQ(unit.QueryFieldUnsigned<ieDword>(6, 3), ieDword(-1));
+	EXPECT_EQ(unit.QueryFieldSigned<int>(StringView("FLUFFINESS"), StringView("NAME_REF")), -1);
+	EXPECT_EQ(unit.QueryFieldSigned<int>(0, 3), 0);
+	EXPECT_EQ(unit.QueryFieldSigned<int8_t>(0, 0), int8_t(127));
+}
+
 TEST_P(p2DAImporterTest, QueryDefault)
 {
 	EXPECT_EQ(unit.QueryDefault(), std::string { "-1" });
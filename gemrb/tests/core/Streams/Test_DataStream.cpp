@@ -217,6 +217,40 @@ TEST(DataStreamWritingTest, Writes)
 	}
 }
 
+TEST(DataStreamViewTest, MappedSlices)
+{
+	MappedFileMemoryStream stream { READ_TEST_FILE };
+	ASSERT_TRUE(stream.isOk());
+
+	DataStream* slice = stream.Slice(7, 9);
+	ASSERT_NE(slice, nullptr);
+	EXPECT_EQ(slice->Size(), strpos_t(9));
+
+	auto view = static_cast<const char*>(slice->View(9));
+	ASSERT_NE(view, nullptr);
+	EXPECT_EQ(std::string(view, 9), "Text text");
+	EXPECT_EQ(slice->Remains(), strpos_t(0));
+	EXPECT_EQ(slice->View(1), nullptr);
+
+	// clones share the mapping, but not the position
+	DataStream* clone = slice->Clone();
+	delete slice;
+	FixedSizeString<4> buffer;
+	EXPECT_EQ(clone->ReadRTrimString(buffer, 4), 4);
+	EXPECT_EQ(buffer, "Text");
+	delete clone;
+
+	EXPECT_EQ(stream.Slice(50, 10), nullptr);
+}
+
+TEST(DataStreamViewTest, NoViewForFiles)
+{
+	FileStream stream {};
+	stream.Open(READ_TEST_FILE);
+	EXPECT_EQ(stream.View(1), nullptr);
+	EXPECT_EQ(stream.GetPos(), strpos_t(0));
+}
+
 static DataStream* createFileStream(const path_t& path)
 {
 	auto fstream = new FileStream();
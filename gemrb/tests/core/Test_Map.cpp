@@ -20,6 +20,7 @@
 // FIXME: remove once fixed, this is excluding non-linux build bots
 #if defined(USE_OPENGL_BACKEND) || (!defined(__APPLE__) && !defined(WIN32))
 
+#include "../../core/EffectQueue.h"
 #include "../../core/GameData.h"
 #include "../../core/Interface.h"
 #include "../../core/InterfaceConfig.h"
@@ -28,6 +29,8 @@
 #include "../../core/Map.h"
 #include "../../core/PluginMgr.h"
 #include "../../core/SaveGameMgr.h"
+#include "../../core/Scriptable/Actor.h"
+#include "../../includes/ie_stats.h"
 
 #include <gtest/gtest.h>
 
@@ -150,5 +153,55 @@ TEST_F(MapTest, FindPathTest)
 	EXPECT_TRUE(path);
 	EXPECT_GT(path.Size(), 1);
 }
+
+// a typically buffed actor has only effects that the effect stat cache can reuse
+TEST_F(MapTest, BuffedActorStatsCacheTest)
+{
+	Actor* actor = gamedata->GetCreature("rabbit");
+	ASSERT_NE(actor, nullptr);
+	map->AddActor(actor, true);
+
+	static EffectRef toHitRef = { "ToHitModifier", -1 };
+	static EffectRef acRef = { "ACVsDamageTypeModifier", -1 };
+	static EffectRef saveRef = { "SaveVsSpellsModifier", -1 };
+	static EffectRef hasteRef = { "State:Hasted", -1 };
+	static EffectRef iconRef = { "Icon:Display", -1 };
+	EffectQueue buffs;
+	auto addBuff = [&buffs](EffectRef& ref, ieDword param1, ieDword param2) {
+		Effect* fx = EffectQueue::CreateEffect(ref, param1, param2, FX_DURATION_INSTANT_LIMITED);
+		fx->Duration = 60;
+		buffs.AddEffect(fx);
+	};
+	addBuff(toHitRef, 1, MOD_ADDITIVE);
+	addBuff(acRef, 1, 0);
+	addBuff(saveRef, 1, 0);
+	addBuff(hasteRef, 0, 0);
+	addBuff(iconRef, 0, 0);
+	core->ApplyEffectQueue(&buffs, actor, actor);
+
+	// the first refresh applies the effects and caches the result
+	actor->RefreshEffects();
+	std::vector<EffectQueue::StatInput> inputs;
+	ieDword validUntil = UINT32_MAX;
+	EXPECT_TRUE(actor->fxqueue.GetStatInputs(inputs, validUntil));
+	EXPECT_EQ(inputs.size(), 5);
+	EXPECT_GT(validUntil, core->GetGame()->GameTime);
+
+	std::vector<Actor::stat_t> stats;
+	for (unsigned int stat = 0; stat < MAX_STATS; ++stat) {
+		stats.push_back(actor->GetStat(stat));
+	}
+	int ac = actor->AC.GetTotal();
+	int toHit = actor->ToHit.GetTotal();
+	EXPECT_TRUE(actor->GetStat(IE_STATE_ID) & STATE_HASTED);
+
+	// ... and the second one reuses it, with the same outcome
+	actor->RefreshEffects();
+	for (unsigned int stat = 0; stat < MAX_STATS; ++stat) {
+		EXPECT_EQ(actor->GetStat(stat), stats[stat]) << "stat: " << stat << std::endl;
+	}
+	EXPECT_EQ(actor->AC.GetTotal(), ac);
+	EXPECT_EQ(actor->ToHit.GetTotal(), toHit);
+}
 }
 #endif